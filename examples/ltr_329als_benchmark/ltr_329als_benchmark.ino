@@ -0,0 +1,231 @@
+/*
+
+Module: ltr_329als_benchmark.ino
+
+Function:
+        Throughput benchmark for the LTR-329ALS library.
+
+Copyright and License:
+        See accompanying LICENSE file.
+
+Author:
+        Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include <mcci_ltr_329als.h>
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <cstdint>
+
+/****************************************************************************\
+|
+|   Manifest constants & typedefs.
+|
+\****************************************************************************/
+
+using namespace Mcci_Ltr_329als;
+
+/// the number of samples to take for each combination, after warm-up.
+static constexpr std::uint16_t kSamplesPerRun = 16;
+
+/// the bus speeds to test, in Hz.
+static constexpr std::uint32_t kBusSpeeds[] = { 100000, 400000 };
+
+/// the legal measurement rates, in ms.
+static constexpr AlsMeasRate_t::Rate_t kRates[] = { 50, 100, 200, 500, 1000, 2000 };
+
+/// results of one run
+struct Result_t
+    {
+    std::uint32_t   elapsedUs;      ///< wall-clock time for the run
+    std::uint32_t   cpuUs;          ///< time spent in driver calls
+    std::uint64_t   busyNs;         ///< modeled bus occupancy for the run
+    Ltr_329als::Statistics_t stats; ///< driver counters for the run
+    };
+
+/****************************************************************************\
+|
+|   Variables.
+|
+\****************************************************************************/
+
+Ltr_329als gLtr {Wire};
+I2cBusTiming_t gBusTiming;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+void printFailure(const char *pMessage)
+    {
+    for (;;)
+        {
+        Serial.print(pMessage);
+        Serial.print(", error: ");
+        Serial.print(gLtr.getLastErrorName());
+        Serial.print("(");
+        Serial.print(std::uint8_t(gLtr.getLastError()));
+        Serial.println(")");
+        delay(2000);
+        }
+    }
+
+// wait for one sample, accumulating time spent in the driver.
+void waitForSample(std::uint32_t &cpuUs)
+    {
+    bool fError;
+    bool fReady;
+
+    do  {
+        auto const tStart = micros();
+        fReady = gLtr.queryReady(fError);
+        cpuUs += micros() - tStart;
+
+        if (fError)
+            printFailure("queryReady() failed");
+        } while (! fReady);
+    }
+
+// take kSamplesPerRun samples in the given mode.
+Result_t runOne(bool fSingle, AlsMeasRate_t::Rate_t rate, AlsMeasRate_t::Integration_t iTime)
+    {
+    Result_t result {};
+
+    if (! gLtr.configure(Ltr_329als::kInitialGain, rate, iTime))
+        printFailure("configure() failed");
+
+    // the first continuous sample takes one integration time, not one
+    // measurement period; so start, and discard it before timing.
+    if (! fSingle)
+        {
+        if (! gLtr.startMeasurement(false))
+            printFailure("startMeasurement() failed");
+
+        std::uint32_t warmupUs = 0;
+        waitForSample(warmupUs);
+        }
+
+    gLtr.resetStatistics();
+    gBusTiming.reset();
+    auto const tStart = micros();
+
+    if (fSingle)
+        {
+        for (auto i = kSamplesPerRun; i > 0; --i)
+            {
+            auto const tCall = micros();
+            if (! gLtr.startSingleMeasurement())
+                printFailure("startSingleMeasurement() failed");
+            result.cpuUs += micros() - tCall;
+
+            waitForSample(result.cpuUs);
+            }
+        }
+    else
+        {
+        for (auto i = kSamplesPerRun; i > 0; --i)
+            waitForSample(result.cpuUs);
+
+        gLtr.stopMeasurement();
+        }
+
+    result.elapsedUs = micros() - tStart;
+    result.stats = gLtr.getStatistics();
+    result.busyNs = gBusTiming.getBusyNs();
+    return result;
+    }
+
+void printResult(const char *pMode, std::uint32_t busHz, AlsMeasRate_t::Rate_t rate, AlsMeasRate_t::Integration_t iTime, const Result_t &r)
+    {
+    auto const nSamples = r.stats.nSamples ? r.stats.nSamples : 1;
+    auto const elapsedUs = r.elapsedUs ? r.elapsedUs : 1;
+
+    Serial.print(pMode);
+    Serial.print(",");
+    Serial.print(busHz / 1000);
+    Serial.print(",");
+    if (rate == 0)
+        Serial.print("-");
+    else
+        Serial.print(rate);
+    Serial.print(",");
+    Serial.print(iTime);
+    Serial.print(",");
+    // samples per second
+    Serial.print(float(r.stats.nSamples) * 1.0e6f / elapsedUs, 3);
+    Serial.print(",");
+    // bus utilization, percent
+    Serial.print(I2cBusTiming_t::utilizationPpm(r.busyNs, std::uint64_t(elapsedUs) * 1000u) / 10000.0f, 4);
+    Serial.print(",");
+    // cpu us per sample
+    Serial.print(r.cpuUs / nSamples);
+    Serial.print(",");
+    // polls per sample
+    Serial.println(float(r.stats.nPolls) / nSamples, 1);
+    }
+
+void setup()
+    {
+    Serial.begin(115200);
+
+    // wait for USB to be attached.
+    while (! Serial)
+        yield();
+
+    Serial.println("LTR329-ALS01 Benchmark");
+    // let message get out.
+    delay(1000);
+
+    if (! gLtr.begin())
+        printFailure("gLtr.begin() failed");
+
+    gLtr.setBusTiming(&gBusTiming);
+    }
+
+// print the table of results.
+void runBenchmark()
+    {
+    Serial.print("library version ");
+    Serial.print(Ltr_329als::kVersion.getMajor());
+    Serial.print(".");
+    Serial.print(Ltr_329als::kVersion.getMinor());
+    Serial.print(".");
+    Serial.println(Ltr_329als::kVersion.getPatch());
+    Serial.println("mode,kHz,rate_ms,integration_ms,samples_per_s,bus_util_pct,cpu_us_per_sample,polls_per_sample");
+
+    for (auto const busHz : kBusSpeeds)
+        {
+        Wire.setClock(busHz);
+        gBusTiming.setClock(busHz);
+
+        // single measurements don't use the rate, so only vary integration time.
+        for (auto const iTime : AlsMeasRate_t::vTimes)
+            printResult("single", busHz, 0, iTime, runOne(true, Ltr_329als::kInitialMeasurementRate, iTime));
+
+        for (auto const rate : kRates)
+            {
+            for (auto const iTime : AlsMeasRate_t::vTimes)
+                {
+                // rate can't be shorter than the integration time.
+                if (rate < iTime)
+                    continue;
+
+                printResult("continuous", busHz, rate, iTime, runOne(false, rate, iTime));
+                }
+            }
+        }
+
+    Serial.println("done");
+    }
+
+void loop()
+    {
+    runBenchmark();
+
+    for (;;)
+        yield();
+    }
@@ -0,0 +1,136 @@
+/*
+
+Module: ltr_329als_flicker.ino
+
+Function:
+        Measure light flicker and choose an integration time to reject it.
+
+Copyright and License:
+        See accompanying LICENSE file.
+
+Author:
+        Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include <mcci_ltr_329als.h>
+#include <mcci_ltr_329als_flicker.h>
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <cstdint>
+
+/****************************************************************************\
+|
+|   Manifest constants & typedefs.
+|
+\****************************************************************************/
+
+using namespace Mcci_Ltr_329als;
+
+/// the mains frequency where we're deployed; change to 50 as needed.
+static constexpr std::uint8_t kMainsHz = 60;
+
+/// the number of samples in a diagnostic burst.
+static constexpr std::uint16_t kBurstSamples = 64;
+
+/// the measurement rate for normal operation, in ms.
+static constexpr AlsMeasRate_t::Rate_t kNormalRate = 1000;
+
+/// the acceptable residual flicker, in parts per thousand.
+static constexpr std::uint16_t kTargetPermille = 5;
+
+/****************************************************************************\
+|
+|   Variables.
+|
+\****************************************************************************/
+
+Ltr_329als gLtr {Wire};
+FlickerEstimator_t gFlicker;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+void printFailure(const char *pMessage)
+    {
+    for (;;)
+        {
+        Serial.print(pMessage);
+        Serial.print(", error: ");
+        Serial.print(gLtr.getLastErrorName());
+        Serial.print("(");
+        Serial.print(std::uint8_t(gLtr.getLastError()));
+        Serial.println(")");
+        delay(2000);
+        }
+    }
+
+void runFlickerBurst()
+    {
+    bool fError;
+
+    if (! gLtr.configure(
+            Ltr_329als::kInitialGain,
+            FlickerEstimator_t::kBurstRate,
+            FlickerEstimator_t::kBurstIntegration
+            ))
+        printFailure("gLtr.configure() failed");
+
+    gFlicker.begin(kBurstSamples);
+    if (! gLtr.startMeasurement(false))
+        printFailure("gLtr.startMeasurement() failed");
+
+    do  {
+        while (! gLtr.queryReady(fError))
+            {
+            if (fError)
+                printFailure("queryReady() failed");
+            }
+        } while (! gFlicker.update(gLtr.getRawData()));
+
+    gLtr.stopMeasurement();
+    }
+
+void setup()
+    {
+    Serial.begin(115200);
+
+    // wait for USB to be attached.
+    while (! Serial)
+        yield();
+
+    Serial.println("LTR329-ALS01 Flicker Test");
+    // let message get out.
+    delay(1000);
+
+    if (! gLtr.begin())
+        printFailure("gLtr.begin() failed");
+    }
+
+void loop()
+    {
+    runFlickerBurst();
+
+    auto const iTime = gFlicker.recommendIntegration(kMainsHz, kNormalRate, kTargetPermille);
+
+    Serial.print("flicker=");
+    Serial.print(gFlicker.getAmplitudePermille());
+    Serial.print(" permille (p-p ");
+    Serial.print(gFlicker.getPeakToPeakPermille());
+    Serial.print("), alias=");
+    Serial.print(gFlicker.getAliasFrequency());
+    Serial.print(" Hz, recommended integration=");
+    Serial.print(iTime);
+    Serial.println(" ms");
+
+    // auto-select the recommended integration time.
+    if (iTime != 0 &&
+        ! gLtr.configure(Ltr_329als::kInitialGain, kNormalRate, iTime))
+        printFailure("gLtr.configure() failed");
+
+    delay(10000);
+    }
@@ -0,0 +1,136 @@
+/*
+
+Module: mcci_ltr_303als.cpp
+
+Function:
+    Implementation code for the LTR-303ALS light sensor.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "mcci_ltr_303als.h"
+#include <Arduino.h>
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+// protected
+bool Ltr_303als::beginInitial()
+    {
+    if (! this->Ltr_329als::beginInitial())
+        return false;
+
+    if (! this->writeInterruptRegisters())
+        {
+        this->setState(State::Uninitialized);
+        return false;
+        }
+
+    return true;
+    }
+
+bool Ltr_303als::setInterruptThresholds(
+    std::uint16_t lower,
+    std::uint16_t upper,
+    std::uint8_t persistence
+    )
+    {
+    WcetRecorder_t::Scope_t const wcet(this->getWcetRecorder(), WcetRecorder_t::Method::SetInterruptThresholds);
+
+    if (! (lower < upper) || persistence < 1 || persistence > 16)
+        return this->setLastError(Error::InvalidParameter);
+
+    this->m_thresholdLow = lower;
+    this->m_thresholdHigh = upper;
+    this->m_persist = persistence - 1;
+    this->m_fHardThresholds = true;
+
+    if (! this->isRunning())
+        return true;
+
+    return this->writeInterruptRegisters();
+    }
+
+bool Ltr_303als::clearInterruptThresholds()
+    {
+    WcetRecorder_t::Scope_t const wcet(this->getWcetRecorder(), WcetRecorder_t::Method::ClearInterruptThresholds);
+
+    // a sample is "out of range" if above upper or below lower,
+    // so these values make every sample assert the interrupt.
+    this->m_thresholdLow = 0xFFFF;
+    this->m_thresholdHigh = 0;
+    this->m_persist = 0;
+    this->m_fHardThresholds = false;
+
+    if (! this->isRunning())
+        return true;
+
+    return this->writeInterruptRegisters();
+    }
+
+// protected
+bool Ltr_303als::writeInterruptRegisters()
+    {
+    std::uint8_t const thresholds[4] =
+        {
+        std::uint8_t(this->m_thresholdHigh), std::uint8_t(this->m_thresholdHigh >> 8),
+        std::uint8_t(this->m_thresholdLow), std::uint8_t(this->m_thresholdLow >> 8),
+        };
+    std::uint8_t interrupt = std::uint8_t(Params::INTERRUPT_BITS::RESERVED) |
+                             std::uint8_t(Params::INTERRUPT_BITS::MODE);
+
+    if (this->m_polarity == IntPolarity::ActiveHigh)
+        interrupt |= std::uint8_t(Params::INTERRUPT_BITS::POLARITY);
+
+    return this->writeRegisters(toRegister(Params::IntReg_t::ALS_THRES_UP_0), thresholds, sizeof(thresholds)) &&
+           this->writeRegister(toRegister(Params::IntReg_t::INTERRUPT_PERSIST), this->m_persist) &&
+           this->writeRegister(toRegister(Params::IntReg_t::INTERRUPT), interrupt);
+    }
+
+// protected
+bool Ltr_303als::isStatusDue(std::uint32_t now, bool &fError)
+    {
+    fError = false;
+
+    if (! this->m_fInterrupt)
+        {
+        // with hardware thresholds, the interrupt only comes when
+        // the light leaves the window.
+        if (this->m_fHardThresholds)
+            {
+            // so continuous measurements can't time out...
+            if (this->getState() == State::Continuous)
+                return this->setLastError(Error::Busy);
+
+            // ...and a single measurement inside the window never
+            // asserts INT; poll ALS_STATUS instead.
+            return this->Ltr_329als::isStatusDue(now, fError);
+            }
+
+        if (this->isTimedOut(now))
+            {
+            fError = true;
+            this->setLastError(Error::TimedOut);
+            this->setState(State::Uninitialized);
+            return false;
+            }
+
+        return this->setLastError(Error::Busy);
+        }
+
+    // reading ALS_STATUS releases the INT pin.
+    this->m_fInterrupt = false;
+    return true;
+    }
+
+/**** end of mcci_ltr_303als.cpp ****/
@@ -0,0 +1,134 @@
+/*
+
+Module: mcci_ltr_303als.h
+
+Function:
+    Driver for the interrupt-capable LTR-303ALS.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+/// \file
+
+#ifndef _mcci_ltr_303als_h_
+#define _mcci_ltr_303als_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include "mcci_ltr_329als.h"
+
+namespace Mcci_Ltr_329als {
+
+///
+/// \brief instance object for LTR-303ALS
+///
+/// \details
+///     The LTR-303ALS is register-compatible with the LTR-329ALS, but
+///     adds threshold registers and an \c INT pin. This driver
+///     uses the interrupt to find out when data is ready, so that
+///     queryReady() never polls \c ALS_STATUS; it only talks to the
+///     sensor after the \c INT line has been asserted.
+///
+///     The driver doesn't touch pins itself. The application (or a
+///     simulation) reports the interrupt by calling notifyInterrupt(),
+///     which is safe to call from an interrupt handler. For example:
+///
+///     \code
+///     Ltr_303als gLtr {Wire};
+///
+///     void setup()
+///         {
+///         pinMode(kPinLtrInt, INPUT_PULLUP);
+///         attachInterrupt(digitalPinToInterrupt(kPinLtrInt), [](){ gLtr.notifyInterrupt(); }, FALLING);
+///         gLtr.begin();
+///         }
+///     \endcode
+///
+///     By default, the interrupt is asserted for every measurement.
+///     If hardware thresholds are set with setInterruptThresholds(),
+///     the interrupt is only asserted when channel 0 leaves the
+///     window, and no timeout applies to continuous measurements; the
+///     MCU can sleep until the light changes. A single measurement
+///     inside the window doesn't assert the interrupt, so while
+///     thresholds are set, single measurements poll \c ALS_STATUS
+///     as the LTR-329ALS does.
+///
+class Ltr_303als : public Ltr_329als
+    {
+public:
+    /// \brief the parameters for this part.
+    using Params = LTR_303ALS_PARAMS;
+
+    /// \brief polarity of the \c INT pin
+    enum class IntPolarity : std::uint8_t
+        {
+        ActiveLow,          ///< \c INT is pulled low when asserted (the default).
+        ActiveHigh,         ///< \c INT is driven high when asserted.
+        };
+
+    ///
+    /// \brief the constructor
+    ///
+    /// \param [in] myWire is the TwoWire bus to use for this sensor.
+    /// \param [in] polarity is the polarity of the \c INT pin.
+    ///
+    Ltr_303als(TwoWire &myWire, IntPolarity polarity = IntPolarity::ActiveLow)
+        : Ltr_329als(myWire)
+        , m_polarity(polarity)
+        {}
+
+    ///
+    /// \brief set hardware thresholds for the interrupt.
+    ///
+    /// \param [in] lower is the lower threshold, in channel 0 counts.
+    /// \param [in] upper is the upper threshold, in channel 0 counts.
+    /// \param [in] persistence is the number of consecutive samples that
+    ///     must be outside the window before the interrupt is asserted,
+    ///     in [1, 16].
+    ///
+    /// \return \c true for success, \c false for failure.
+    ///
+    bool setInterruptThresholds(std::uint16_t lower, std::uint16_t upper, std::uint8_t persistence = 1);
+
+    /// \brief assert the interrupt for every measurement (the default).
+    bool clearInterruptThresholds();
+
+    /// \brief record that the \c INT pin has been asserted; safe to call from an ISR.
+    void notifyInterrupt()
+        {
+        this->m_fInterrupt = true;
+        }
+
+protected:
+    /// \brief set up the initial configuration, then enable the interrupt.
+    virtual bool beginInitial() override;
+
+    /// \brief wait for the interrupt instead of polling \c ALS_STATUS.
+    virtual bool isStatusDue(std::uint32_t now, bool &fError) override;
+
+    /// \brief convert an LTR-303ALS register to a driver register value.
+    static constexpr Register_t toRegister(Params::IntReg_t r)
+        {
+        return Register_t(std::uint8_t(r));
+        }
+
+    /// \brief write the threshold, persistence and interrupt registers.
+    bool writeInterruptRegisters();
+
+private:
+    volatile bool   m_fInterrupt = false;       ///< set when INT is asserted
+    IntPolarity     m_polarity;                 ///< polarity of INT pin
+    std::uint16_t   m_thresholdLow = 0xFFFF;    ///< hardware lower threshold
+    std::uint16_t   m_thresholdHigh = 0;        ///< hardware upper threshold
+    std::uint8_t    m_persist = 0;              ///< value for INTERRUPT_PERSIST
+    bool            m_fHardThresholds = false;  ///< true if thresholds are set
+    };
+
+} // end namespace Mcci_Ltr_329als
+
+#endif /* _mcci_ltr_303als_h_ */
@@ -15,25 +15,20 @@ Author:
 
 #include "mcci_ltr_329als.h"
 #include <Arduino.h>
+#include <cstddef>
 #include <cstdint>
 #include <stdint.h>
 
 using namespace Mcci_Ltr_329als;
 
-/****************************************************************************\
-|
-|   Manifest constants & typedefs.
-|
-\****************************************************************************/
-
-static const char *scanMultiSzString(const char *p, unsigned eIndex);
-
 /****************************************************************************\
 |
 |   Read-only data.
 |
 \****************************************************************************/
 
+// out-of-line definition, needed before C++17 if vTimes[] is odr-used.
+constexpr Mcci_Ltr_329als_Regs::AlsMeasRate_t::Integration_t Mcci_Ltr_329als_Regs::AlsMeasRate_t::vTimes[];
 
 
 /****************************************************************************\
@@ -57,16 +52,21 @@ Definition:
 
 Description:
     If the driver is already running, this function succeed.
-    Otherwise, this function assumes that the sensor has just
-    been powered up, and records the time.
-    Probe and so forth are delayed until the 100ms delay has elapsed.
+    Otherwise, this function assumes that the sensor may have just
+    been powered up. It runs startBegin(), then polls
+    queryBeginDone() until start-up is finished, calling yield()
+    between polls. Instead of waiting a fixed 100 ms, the state
+    machine probes PART_ID with exponential backoff until the
+    sensor answers correctly, both before and after the reset.
+    The whole start-up is bounded by getMaxInitialDelayMs() plus
+    the wakeup delay.
 
 Returns:
     true for success, false for failure. If any errors, then
     Ltr_329als::getLastError() will return the error cause.
 
 Notes:
-
+    The time taken is available from getBootTimeMs().
 
 */
 
@@ -77,6 +77,29 @@ Ltr_329als::begin(
     void
     )
     {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::Begin);
+
+    if (! this->startBegin())
+        return false;
+
+    bool fError;
+    while (! this->queryBeginDone(fError))
+        {
+        if (fError)
+            return false;
+
+        yield();
+        }
+
+    return true;
+    }
+
+#undef FUNCTION
+
+bool Ltr_329als::startBegin()
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::StartBegin);
+
     // if no Wire is bound, fail.
     if (this->m_wire == nullptr)
         return this->setLastError(Error::NoWire);
@@ -85,61 +108,295 @@ Ltr_329als::begin(
         return true;
 
     this->m_wire->begin();
-    bool result = this->readProductInfo();
 
-    if (result && (this->getState() == State::Uninitialized))
-        {
-        if (! this->reset())
-            return false;
+    this->m_beginTime = millis();
+    this->m_startTime = this->m_beginTime;
+    this->m_delay = 0;
+    this->m_probeInterval = 1;
+    this->setState(State::PowerOff);
+    return true;
+    }
+
+/*
 
-        this->m_startTime = millis();
-        this->m_delay = LTR_329ALS_PARAMS::getInitialDelayMs();
+Name:	Ltr_329als::queryBeginDone()
 
-        this->setState(State::PowerOn);
+Function:
+    Advance start-up begun by startBegin(), without blocking.
 
-        // TODO(tmm@mcci.com): we should use an explicit FSM so that
-        // we can embed this in a pollable object and NOT waste battery
-        // while polling.
-        while ((std::uint32_t)millis() - this->m_startTime < this->m_delay)
-            ;
+Definition:
+    bool Ltr_329als::queryBeginDone(
+        bool &fError
+        );
+
+Description:
+    This is begin() as a state machine. In State::PowerOff we probe
+    for the sensor to power up; when it answers, we read the product
+    info and reset it, and go to State::PowerOn, where we probe for
+    the end of the reset. Then we set up the initial configuration
+    and wait in State::Initial for the wakeup delay, before going to
+    State::Idle. The wait between probes starts at 1 ms and
+    doubles, up to kMaxProbeIntervalMs, so a sensor that is already
+    running is found at once, while a sensor that is still starting
+    is not flooded with transfers.
+
+    Each call makes at most one PART_ID read, or (once) the product
+    info reads and the reset write; it never waits.
+
+Returns:
+    true once the driver is idle. false if start-up is still in
+    progress (fError false), or if it failed (fError true; the
+    last error is set and the driver is uninitialized).
+
+*/
+
+#define FUNCTION "Ltr_329als::queryBeginDone"
+
+bool
+Ltr_329als::queryBeginDone(
+    bool &fError
+    )
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::QueryBeginDone);
+
+    fError = false;
+    if (! this->checkRunning())
+        {
+        fError = true;
+        return false;
+        }
+
+    auto const state = this->getState();
+    if (state > State::Initial)
+        return true;
 
-        this->setState(State::Initial);
+    ms_t const now = millis();
+    if (this->isBeginWaiting(now))
+        return false;
 
-        // for power reasons, we do NOT set "active" mode. We leave
-        // the sensor in sleep mode until it's time to make a measurement.
+    if (state == State::Initial)
+        {
+        this->m_bootTime = now - this->m_beginTime;
+        this->setState(State::Idle);
+        return true;
+        }
 
-        // set gain, measurement and integration time for white LED
-        // This only sets register images; it doesn't write to the sensor.
-        if (! this->configure(
-                this->kInitialGain,
-                this->kInitialMeasurementRate,
-                this->kInitialIntegrationTime
-                ))
+    // PowerOff or PowerOn: probe once.
+    if (this->probeOnce())
+        {
+        if (state == State::PowerOff)
             {
-            // last error was set. Set state to uniitialized.
-            this->setState(State::Uninitialized);
-            return false;
+            if (this->readProductInfo() && this->reset())
+                {
+                // probe for the end of the reset at once.
+                this->setState(State::PowerOn);
+                this->m_startTime = now;
+                this->m_delay = 0;
+                this->m_probeInterval = 1;
+                return false;
+                }
             }
+        else if (this->beginInitial())
+            return false;
 
-        this->m_startTime = millis();
-        this->m_delay = LTR_329ALS_PARAMS::getWakeupDelayMs();
+        this->setState(State::Uninitialized);
+        fError = true;
+        return false;
+        }
+
+    ms_t const elapsed = now - this->m_beginTime;
+    if (elapsed >= LTR_329ALS_PARAMS::getMaxInitialDelayMs())
+        {
+        this->setState(State::Uninitialized);
+        fError = true;
+        return false;
+        }
 
-        // TODO(tmm@mcci.com): we should use an explicit FSM so that
-        // we can embed this in a pollable object and NOT waste battery
-        // while polling.
-        while ((std::uint32_t)millis() - this->m_startTime < this->m_delay)
-            /* don't put this semicolon on previous line! */;
+    // don't wait past the deadline.
+    ms_t waitMs = LTR_329ALS_PARAMS::getMaxInitialDelayMs() - elapsed;
+    if (waitMs > this->m_probeInterval)
+        waitMs = this->m_probeInterval;
 
-        this->setState(State::Idle);
+    this->m_startTime = now;
+    this->m_delay = waitMs;
+
+    if (this->m_probeInterval < kMaxProbeIntervalMs)
+        this->m_probeInterval *= 2;
+
+    return false;
+    }
+
+#undef FUNCTION
+
+// protected
+bool Ltr_329als::beginInitial()
+    {
+    this->setState(State::Initial);
+
+    // for power reasons, we do NOT set "active" mode. We leave
+    // the sensor in sleep mode until it's time to make a measurement.
+
+    // set gain, measurement and integration time for white LED
+    // This only sets register images; it doesn't write to the sensor.
+    if (! this->configure(
+            this->kInitialGain,
+            this->kInitialMeasurementRate,
+            this->kInitialIntegrationTime
+            ))
+        {
+        // last error was set. Set state to uniitialized.
+        this->setState(State::Uninitialized);
+        return false;
         }
 
-    return result;
+    this->m_startTime = millis();
+    this->m_delay = LTR_329ALS_PARAMS::getWakeupDelayMs();
+    return true;
+    }
+
+// protected
+bool Ltr_329als::probeOnce()
+    {
+    std::uint8_t uPartId;
+
+    if (! this->readRegister(Register_t::PART_ID, uPartId))
+        return false;
+
+    if (PartID_t(uPartId).getPartID() != PartID_t::kPartID)
+        return this->setLastError(Error::PartIdMismatch);
+
+    return true;
+    }
+
+static_assert(sizeof(Ltr_329als::RetainedState_t) == 16, "RetainedState_t must not be padded");
+
+bool Ltr_329als::saveState(RetainedState_t &state)
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::SaveState);
+
+    if (! this->checkRunning())
+        return false;
+
+    auto const s = this->getState();
+    if (! (s == State::Idle || s == State::Initial))
+        return this->setLastError(Error::Busy);
+
+    state.magic = kRetainedStateMagic;
+    state.userRate = this->m_measrate.getRate();
+    state.userIntegration = this->m_measrate.getIntegration();
+    state.control = this->m_control.getValue();
+    state.measrate = this->m_measrate.getValue();
+    state.sensorMeasRate = this->m_sensorMeasRate.getValue();
+    state.partid = this->m_partid.getValue();
+    state.manufacid = this->m_manufacid.getValue();
+    state.userGain = this->m_userGain;
+    state.reserved = 0;
+    state.check = computeRetainedCheck(state);
+    return true;
+    }
+
+/*
+
+Name:	Ltr_329als::resume()
+
+Function:
+    Restart the driver after MCU deep sleep, using retained state.
+
+Definition:
+    bool Ltr_329als::resume(
+        const RetainedState_t &state
+        );
+
+Description:
+    If the driver is already running, this function succeeds.
+    Otherwise, the retained state is checked. If it's valid, a
+    single read of ALS_MEAS_RATE, PART_ID and MANUFAC_ID (which
+    are adjacent) confirms that the sensor is the one that was
+    configured, and that it hasn't been reset: a power cycle
+    returns ALS_MEAS_RATE to its reset value. The register
+    shadows are then restored and the driver enters State::Idle.
+
+    If the read fails, or anything doesn't match, we fall back to
+    begin(). Derived classes set up their own registers in
+    beginInitial(), which begin() calls, so the fallback
+    initializes them too.
+
+Returns:
+    true for success, false for failure. If any errors, then
+    Ltr_329als::getLastError() will return the error cause.
+
+Notes:
+    If the last value written to ALS_MEAS_RATE was the reset
+    value, a power cycle can't be detected. This is harmless:
+    every measurement rewrites ALS_MEAS_RATE and ALS_CONTR.
+
+*/
+
+#define FUNCTION "Ltr_329als::resume"
+
+bool
+Ltr_329als::resume(
+    const RetainedState_t &state
+    )
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::Resume);
+
+    // if no Wire is bound, fail.
+    if (this->m_wire == nullptr)
+        return this->setLastError(Error::NoWire);
+
+    if (this->isRunning())
+        return true;
+
+    if (state.magic != kRetainedStateMagic || state.check != computeRetainedCheck(state))
+        return this->begin();
+
+    this->m_wire->begin();
+
+    // ALS_MEAS_RATE, PART_ID, MANUFAC_ID. If the sensor doesn't
+    // answer, it may have lost power; begin() waits for it.
+    std::uint8_t regs[3];
+    if (! this->readRegisters(Register_t::ALS_MEAS_RATE, regs, sizeof(regs)))
+        return this->begin();
+
+    if (regs[0] != state.sensorMeasRate ||
+        regs[1] != state.partid ||
+        regs[2] != state.manufacid)
+        return this->begin();
+
+    this->m_partid = PartID_t(state.partid);
+    this->m_manufacid = ManufacID_t(state.manufacid);
+    this->m_sensorMeasRate = AlsMeasRate_t(state.sensorMeasRate);
+    this->m_control = AlsContr_t(state.control);
+    this->m_measrate = AlsMeasRate_t(state.measrate);
+    this->m_userGain = state.userGain;
+    this->m_userRate = state.userRate;
+    this->m_userIntegration = state.userIntegration;
+
+    this->m_bootTime = 0;
+    this->setState(State::Idle);
+    return true;
     }
 
 #undef FUNCTION
 
+// protected
+std::uint8_t Ltr_329als::computeRetainedCheck(const RetainedState_t &state)
+    {
+    auto const p = reinterpret_cast<const std::uint8_t *>(&state);
+    std::uint8_t check = 0x5A;
+
+    // rotate and add; enough to catch uninitialized or stale memory.
+    for (size_t i = 0; i < offsetof(RetainedState_t, check); ++i)
+        check = std::uint8_t(((check << 1) | (check >> 7)) + p[i]);
+
+    return check;
+    }
+
 void Ltr_329als::end(void)
     {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::End);
+
     if (this->isRunning())
         this->setState(State::Uninitialized);
 
@@ -149,12 +406,20 @@ void Ltr_329als::end(void)
 
 bool Ltr_329als::reset()
     {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::Reset);
+
+    bool const fResult = this->writeRegister(
+                            Register_t::ALS_CONTR,
+                            AlsContr_t(0).setReset(true).getValue()
+                            );
+
+    // change state after the write, so that a failure's error is traced.
     this->setState(State::Uninitialized);
+    if (! fResult)
+        return false;
 
-    return this->writeRegister(
-                Register_t::ALS_CONTR,
-                AlsContr_t(0).setReset(true).getValue()
-                );
+    this->m_sensorMeasRate = AlsMeasRate_t(LTR_329ALS_PARAMS::kMeasRateResetValue);
+    return true;
     }
 
 bool Ltr_329als::setStandby()
@@ -170,6 +435,8 @@ Ltr_329als::readProductInfo(
     void
     )
     {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::ReadProductInfo);
+
     std::uint8_t uPartId;
     std::uint8_t uManufacId;
 
@@ -198,6 +465,8 @@ Ltr_329als::configure(
     AlsMeasRate_t::Integration_t iTime
     )
     {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::Configure);
+
     if (! (AlsGain_t::isGainValid(g) && AlsMeasRate_t::isRateValid(r) && AlsMeasRate_t::isIntegrationValid(iTime)))
         return this->setLastError(Error::InvalidParameter);
 
@@ -210,6 +479,7 @@ Ltr_329als::configure(
         return this->setLastError(Error::Busy);
 
     this->m_control = this->m_control.setGain(g);
+    this->m_userGain = g;
 
     this->m_measrate =
         AlsMeasRate_t(0)
@@ -223,6 +493,8 @@ Ltr_329als::configure(
 bool
 Ltr_329als::startMeasurement(bool fSingle)
     {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::StartMeasurement);
+
     if (! this->checkRunning())
         return false;
 
@@ -243,132 +515,487 @@ Ltr_329als::startMeasurement(bool fSingle)
             // set the repeat rate really low.
             measrate = measrate.setRate(2000);
 
-        this->m_control = this->m_control
-                                .setActive(true)
-                                .setReset(false)
-                                ;
-
-        if (! this->writeRegister(Register_t::ALS_MEAS_RATE, measrate.getValue()))
-            return false;
-
-        if (this->writeRegister(Register_t::ALS_CONTR, this->m_control.getValue()))
-            {
-            // we started.
-            this->m_startTime = millis();
-            this->m_pollTime = this->m_startTime;
-            this->m_rawChannels.init();
-            this->m_rawChannels.setMeasRate(measrate);
-            this->setState(fSingle ? State::Single : State::Continuous);
-            return true;
-            }
+        return this->activate(measrate, fSingle ? State::Single : State::Continuous);
         }
     }
 
-bool Ltr_329als::queryReady(bool &fError)
+// protected
+bool Ltr_329als::activate(AlsMeasRate_t measrate, State newState)
     {
-    if (! checkRunning())
-        {
-        fError = true;
+    this->m_control = this->m_control
+                            .setActive(true)
+                            .setReset(false)
+                            ;
+
+    if (! this->writeRegister(Register_t::ALS_MEAS_RATE, measrate.getValue()))
         return false;
-        }
 
-    if (this->getState() == State::Ready)
-        {
-        fError = false;
-        return true;
-        }
+    this->m_sensorMeasRate = measrate;
+    if (! this->writeRegister(Register_t::ALS_CONTR, this->m_control.getValue()))
+        return false;
 
-    if (this->getState() == State::Single ||
-        this->getState() == State::Continuous)
-        {
-        auto const now = millis();
+    this->markActive(measrate, newState, millis());
+    return true;
+    }
 
-        // is it time to start talking to the device?
-        if (now - this->m_startTime < this->m_rawChannels.getIntegrationTime())
-            {
-            // not yet
-            this->m_pollTime = now - 10;
-            fError = false;
-            return this->setLastError(Error::Busy);
-            }
+// protected
+void Ltr_329als::markActive(AlsMeasRate_t measrate, State newState, std::uint32_t now)
+    {
+    this->m_control = this->m_control
+                            .setActive(true)
+                            .setReset(false)
+                            ;
+    this->m_sensorMeasRate = measrate;
+
+    // we started.
+    this->m_startTime = now;
+    this->m_pollTime = this->m_startTime;
+    // the first sample is ready after one integration time.
+    this->m_delay = measrate.getIntegration();
+    // keep the last reported value for getLux(maxAge) before clearing the data.
+    this->updateLuxCache();
+    this->m_fRawReported = false;
+    this->m_rawChannels.init();
+    this->m_rawChannels.setMeasRate(measrate);
+    this->m_sample.init();
+    this->m_sample.setMeasRate(measrate);
+    this->m_fHdr = false;
+    this->m_burstRemaining = 0;
+    this->m_fReported = false;
+    this->m_fReportPending = false;
+    this->m_fLuxSingle = false;
+    this->setState(newState);
+    }
 
-        // check the Als data status
-        if (now - this->m_pollTime < 10)
-            {
-            fError = false;
-            return this->setLastError(Error::Busy);
-            }
+/*
 
-        if (! this->readDataStatus())
-            {
-            // data error occurred.
-            this->setState(State::Uninitialized);
-            return false;
-            }
+Name:	Ltr_329als::startHdrMeasurement()
 
-        // don't poll for another 10 ms.
-        this->m_pollTime = now;
+Function:
+    Start continuous measurements, alternating between two gains.
 
-        if (! (this->m_status.getNew() && this->m_status.getValid()))
-            {
-            // check for timeout.
-            if (now - this->m_startTime > 2 * this->m_rawChannels.getIntegrationTime())
-                {
-                fError = true;
-                this->setState(State::Uninitialized);
-                return this->setLastError(Error::TimedOut);
-                }
-            else
-                {
-                fError = false;
-                return this->setLastError(Error::Busy);
-                }
-            }
+Definition:
+    bool Ltr_329als::startHdrMeasurement(
+        AlsGain_t::Gain_t lowGain,
+        AlsGain_t::Gain_t highGain
+        );
 
-        if (! this->readRegisters(
-                        Register_t::ALS_DATA_CH1_0,
-                        this->m_rawChannels.getDataPointer(),
-                        this->m_rawChannels.getDataSize()
-                        ))
-            {
-            // last error is set
-            this->setState(State::Uninitialized);
-            return false;
-            }
+Description:
+    The sensor is started in continuous mode at lowGain. Each time
+    a sample is harvested by queryReady(), the gain in ALS_CONTR is
+    set to the other value. Each sample is filed by the gain that
+    ALS_STATUS reports for it, so the sample already under way when
+    the gain is written is kept, not discarded. When a fresh sample at
+    each gain is available, they are fused: the unsaturated sample with
+    the most counts (and therefore the best SNR) is reported in
+    m_rawChannels, and m_hdrSelect records which one was used.
 
-        // record the status
-        this->m_rawChannels.setStatus(this->m_status);
+Returns:
+    true for success, false for failure. If any errors, then
+    Ltr_329als::getLastError() will return the error cause.
 
-        // change state.
-        if (this->getState() == State::Single)
-            {
-            // idle the device; changes state back to idle.
-            return this->setStandby();
-            }
-        else
-            {
-            // continuous mode keeps measuring. Set up a timeout.
-            this->m_startTime = now;
-            this->m_pollTime = now;
-            return true;
-            }
-        }
-    else
-        {
-        fError = true;
-        return this->setLastError(Error::NotMeasuring);
-        }
-    }
+Notes:
+    The gain requested by configure() is restored by stopMeasurement().
 
-float Ltr_329als::getLux()
-    {
-    bool fError;
-    float ambientLight;
+*/
 
-    // computeLux does everything except set last error...
-    ambientLight = this->m_rawChannels.computeLux(fError);
+#define FUNCTION "Ltr_329als::startHdrMeasurement"
 
-    // so we do that here.
+bool
+Ltr_329als::startHdrMeasurement(
+    AlsGain_t::Gain_t lowGain,
+    AlsGain_t::Gain_t highGain
+    )
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::StartHdrMeasurement);
+
+    if (! (AlsGain_t::isGainValid(lowGain) && AlsGain_t::isGainValid(highGain)))
+        return this->setLastError(Error::InvalidParameter);
+
+    if (! (lowGain < highGain))
+        return this->setLastError(Error::InvalidParameter);
+
+    if (! this->checkRunning())
+        return false;
+
+    if (this->getState() != State::Idle)
+        return this->setLastError(Error::Busy);
+
+    this->m_control = this->m_control.setGain(lowGain);
+    if (! this->startMeasurement(false))
+        {
+        this->m_control = this->m_control.setGain(this->m_userGain);
+        return false;
+        }
+
+    this->m_hdrGain[0] = lowGain;
+    this->m_hdrGain[1] = highGain;
+    this->m_hdrFresh = 0;
+    this->m_hdrSelect = HdrSelect::None;
+    this->m_fHdr = true;
+    return true;
+    }
+
+#undef FUNCTION
+
+/*
+
+Name:	Ltr_329als::startBurst()
+
+Function:
+    Start a burst of back-to-back single measurements.
+
+Definition:
+    bool Ltr_329als::startBurst(
+        std::uint16_t nSamples
+        );
+
+Description:
+    A normal single measurement puts the sensor in standby after
+    the data is read, so the next one pays for the start writes and
+    the wakeup delay. In a burst, the sensor is left active with the
+    measurement rate set as short as the integration time allows;
+    each time queryReady() harvests a sample, the next one is already
+    under way. If a configuration change has been queued with
+    queueBurstConfig(), it's written in the same poll, re-arming the
+    sensor for the next shot. After the last sample, the sensor is
+    put in standby.
+
+Returns:
+    true for success, false for failure. If any errors, then
+    Ltr_329als::getLastError() will return the error cause.
+
+Notes:
+    Use getBurstRateMilliHz() to get the achieved sample rate.
+
+*/
+
+#define FUNCTION "Ltr_329als::startBurst"
+
+bool
+Ltr_329als::startBurst(
+    std::uint16_t nSamples
+    )
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::StartBurst);
+
+    if (nSamples == 0)
+        return this->setLastError(Error::InvalidParameter);
+
+    if (! this->checkRunning())
+        return false;
+
+    if (this->getState() != State::Idle)
+        return this->setLastError(Error::Busy);
+
+    // run the sensor as fast as the integration time allows.
+    auto const measrate = AlsMeasRate_t(this->m_measrate).setRate(this->m_measrate.getIntegration());
+
+    if (! this->activate(measrate, State::Single))
+        return false;
+
+    this->m_saveMeasRate = measrate;
+    this->m_burstRemaining = nSamples;
+    this->m_burstCount = 0;
+    this->m_burstStartTime = this->m_startTime;
+    this->m_burstTime = this->m_startTime;
+    this->m_fBurstConfig = false;
+    this->m_fBurstDiscard = false;
+    return true;
+    }
+
+#undef FUNCTION
+
+bool Ltr_329als::queueBurstConfig(
+    AlsGain_t::Gain_t g,
+    AlsMeasRate_t::Integration_t iTime
+    )
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::QueueBurstConfig);
+
+    if (! (AlsGain_t::isGainValid(g) && AlsMeasRate_t::isIntegrationValid(iTime)))
+        return this->setLastError(Error::InvalidParameter);
+
+    if (this->m_burstRemaining == 0)
+        return this->setLastError(Error::NotMeasuring);
+
+    this->m_burstGain = g;
+    this->m_burstIntegration = iTime;
+    this->m_fBurstConfig = true;
+    return true;
+    }
+
+std::uint32_t Ltr_329als::getBurstRateMilliHz() const
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::GetBurstRate);
+
+    std::uint32_t const elapsed = this->m_burstTime - this->m_burstStartTime;
+
+    if (elapsed == 0)
+        return 0;
+
+    return std::uint32_t((std::uint64_t(this->m_burstCount) * 1000000u) / elapsed);
+    }
+
+bool Ltr_329als::setDeadband(
+    std::uint16_t absCounts,
+    std::uint16_t relPermille,
+    std::uint32_t maxSilenceMs
+    )
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::SetDeadband);
+
+    if (absCounts == 0 && relPermille == 0)
+        return this->setLastError(Error::InvalidParameter);
+
+    this->m_deadbandAbs = absCounts;
+    this->m_deadbandRel = relPermille;
+    this->m_maxSilence = maxSilenceMs;
+    this->m_fReported = false;
+    this->m_fDeadband = true;
+    return true;
+    }
+
+bool Ltr_329als::setThresholds(
+    std::uint16_t lower,
+    std::uint16_t upper,
+    std::uint8_t persistence
+    )
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::SetThresholds);
+
+    if (! (lower < upper) || persistence < 1 || persistence > 16)
+        return this->setLastError(Error::InvalidParameter);
+
+    this->m_thresholdLow = lower;
+    this->m_thresholdHigh = upper;
+    this->m_persistence = persistence;
+    this->m_zone = ThresholdEvent::None;
+    this->m_pendingZone = ThresholdEvent::None;
+    this->m_nPending = 0;
+    this->m_thresholdEvent = ThresholdEvent::None;
+    this->m_fThresholds = true;
+    return true;
+    }
+
+std::uint32_t Ltr_329als::getPollIntervalMs() const
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::GetPollInterval);
+
+    auto const state = this->getState();
+    if (! (state == State::Single || state == State::Continuous))
+        return 0;
+
+    std::uint32_t const elapsed = millis() - this->m_startTime;
+    return (elapsed < this->m_delay) ? this->m_delay - elapsed : 0;
+    }
+
+bool Ltr_329als::stopMeasurement()
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::StopMeasurement);
+
+    if (! this->checkRunning())
+        return false;
+
+    if (! this->prepareStop())
+        return true;
+
+    return this->setStandby();
+    }
+
+// private
+bool Ltr_329als::prepareStop()
+    {
+    auto const state = this->getState();
+    if (! (state == State::Single || state == State::Continuous || state == State::Ready))
+        return false;
+
+    if (this->m_fHdr)
+        {
+        this->m_fHdr = false;
+        this->m_control = this->m_control.setGain(this->m_userGain);
+        }
+
+    this->m_burstRemaining = 0;
+    this->m_fReportPending = false;
+    this->m_fLuxSingle = false;
+    return true;
+    }
+
+bool Ltr_329als::queryReady(bool &fError)
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::QueryReady);
+
+    // a sample harvested by getLux(maxAge) is still to be reported.
+    if (this->m_fReportPending)
+        {
+        this->m_fReportPending = false;
+        fError = false;
+        return true;
+        }
+
+    if (! this->pollMeasurement(fError))
+        return false;
+
+    this->markReported();
+    return true;
+    }
+
+// protected
+void Ltr_329als::markReported()
+    {
+    // remember the reported sample for getLux(maxAge).
+    if (! this->m_fRawReported)
+        {
+        this->m_fRawReported = true;
+        this->m_fLuxPending = true;
+        this->m_luxTime = this->m_sampleTime;
+        }
+    }
+
+// protected
+bool Ltr_329als::pollMeasurement(bool &fError)
+    {
+    ++this->m_stats.nPolls;
+    this->m_fHarvested = false;
+
+    if (! checkRunning())
+        {
+        fError = true;
+        return false;
+        }
+
+    if (this->getState() == State::Ready)
+        {
+        fError = false;
+        return true;
+        }
+
+    if (this->getState() == State::Single ||
+        this->getState() == State::Continuous)
+        {
+        auto const now = millis();
+
+        // is it time to start talking to the device?
+        if (! this->isStatusDue(now, fError))
+            {
+            // error (if any) has been recorded.
+            return false;
+            }
+
+        if (! this->readDataStatus())
+            {
+            // data error occurred.
+            fError = true;
+            this->setState(State::Uninitialized);
+            return false;
+            }
+
+        if (! (this->m_status.getNew() && this->m_status.getValid()))
+            {
+            // check for timeout.
+            if (this->isTimedOut(now))
+                {
+                fError = true;
+                this->setLastError(Error::TimedOut);
+                this->setState(State::Uninitialized);
+                return false;
+                }
+            else
+                {
+                fError = false;
+                return this->setLastError(Error::Busy);
+                }
+            }
+
+        if (! this->readRegisters(
+                        Register_t::ALS_DATA_CH1_0,
+                        this->m_sample.getDataPointer(),
+                        this->m_sample.getDataSize()
+                        ))
+            {
+            // last error is set
+            this->setState(State::Uninitialized);
+            return false;
+            }
+
+        // record the status, and when the sample was read.
+        this->m_harvestTime = now;
+        this->m_sample.setStatus(this->m_status);
+        this->m_sample.updateQuality(this->m_control.getGain());
+        ++this->m_stats.nSamples;
+
+        // change state.
+        if (this->getState() == State::Single)
+            {
+            if (this->m_burstRemaining != 0)
+                return this->processBurstSample(now, fError);
+
+            this->m_fHarvested = true;
+            this->commitSample(now);
+
+            // idle the device; changes state back to idle.
+            return this->setStandby();
+            }
+        else
+            {
+            // continuous mode keeps measuring. Set up a timeout; the
+            // next sample is due one measurement period from now.
+            auto const iTime = this->m_measrate.getIntegration();
+            auto const rate = this->m_measrate.getRate();
+
+            this->m_startTime = now;
+            this->m_pollTime = now;
+            this->m_delay = rate > iTime ? rate : iTime;
+
+            if (this->m_fHdr)
+                {
+                if (! this->processHdrSample(now))
+                    {
+                    fError = this->getState() == State::Uninitialized;
+                    if (! fError)
+                        this->setLastError(Error::Busy);
+                    return false;
+                    }
+                }
+
+            this->m_fHarvested = true;
+            if (! this->filterSample(now))
+                {
+                fError = false;
+                return this->setLastError(Error::Busy);
+                }
+
+            this->commitSample(now);
+            return true;
+            }
+        }
+    else
+        {
+        fError = true;
+        return this->setLastError(Error::NotMeasuring);
+        }
+    }
+
+float Ltr_329als::getLux()
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::GetLux);
+
+    bool fError;
+    float ambientLight;
+
+    // reuse the conversion if this is the last reported sample.
+    if (this->m_fRawReported)
+        {
+        this->updateLuxCache();
+        if (this->m_fLuxCache)
+            return this->m_luxCache;
+        }
+
+    // computeLux does everything except set last error...
+    ambientLight = this->m_rawChannels.computeLux(fError);
+
+    // so we do that here.
     if (fError)
         {
         this->setLastError(Error::InvalidData);
@@ -378,6 +1005,422 @@ float Ltr_329als::getLux()
     return ambientLight;
     }
 
+/*
+
+Name:	Ltr_329als::getLux()
+
+Function:
+    Return lux no older than a given age, measuring if needed.
+
+Definition:
+    bool Ltr_329als::getLux(
+        std::uint32_t maxAgeMs,
+        float &lux,
+        bool &fError
+        );
+
+Description:
+    If the last sample reported by queryReady() was taken no more
+    than maxAgeMs ago, its lux value is returned at once; it is
+    converted only once, however many callers ask for it.
+
+    Otherwise, if the driver is idle, a single measurement is
+    started. If a measurement is already running (whether started
+    by this function, by another caller, or in continuous mode) we
+    join it, so several requesters share one measurement and one
+    set of bus transfers.
+
+    Joining must not take the sample from the caller that started
+    the measurement. So a sample that should be reported, but that
+    this function didn't start, is left pending; the owner's next
+    queryReady() returns true for it. And a sample that the deadband
+    or threshold filters suppress is still used here, though it is
+    not reported and doesn't change getRawData(). Either way, the
+    age of the cached value counts from when the sample was read.
+
+Returns:
+    true if lux has been set. false if the value is not ready yet
+    (fError false, last error Busy), or on error (fError true, last
+    error set).
+
+*/
+
+#define FUNCTION "Ltr_329als::getLux"
+
+bool
+Ltr_329als::getLux(
+    std::uint32_t maxAgeMs,
+    float &lux,
+    bool &fError
+    )
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::GetLuxMaxAge);
+
+    fError = false;
+    if (! this->checkRunning())
+        {
+        fError = true;
+        return false;
+        }
+
+    this->updateLuxCache();
+    if (this->m_fLuxCache && std::uint32_t(millis() - this->m_luxTime) <= maxAgeMs)
+        {
+        lux = this->m_luxCache;
+        return true;
+        }
+
+    if (this->getState() == State::Idle)
+        {
+        if (! this->startSingleMeasurement())
+            {
+            fError = true;
+            return false;
+            }
+
+        this->m_fLuxSingle = true;
+        }
+
+    // a sample harvested earlier is waiting for its owner.
+    if (this->m_fReportPending)
+        return this->setLastError(Error::Busy);
+
+    bool const fReport = this->pollMeasurement(fError);
+    if (fError || ! this->m_fHarvested)
+        {
+        // not ready, or error; last error is set.
+        return false;
+        }
+
+    if (fReport)
+        {
+        // leave the sample for the caller that started the measurement.
+        if (! this->m_fLuxSingle)
+            this->m_fReportPending = true;
+
+        this->m_fLuxSingle = false;
+        this->markReported();
+        this->updateLuxCache();
+        }
+    else
+        {
+        // the filters suppressed it; use it without reporting it.
+        bool fInvalid;
+
+        this->m_luxCache = this->m_sample.computeLux(fInvalid);
+        this->m_fLuxCache = ! fInvalid;
+        this->m_fLuxPending = false;
+        this->m_luxTime = this->m_harvestTime;
+
+        // the cache no longer matches getRawData().
+        this->m_fRawReported = false;
+        }
+
+    if (! this->m_fLuxCache)
+        {
+        fError = true;
+        return this->setLastError(Error::InvalidData);
+        }
+
+    lux = this->m_luxCache;
+    return true;
+    }
+
+#undef FUNCTION
+
+// protected
+void Ltr_329als::updateLuxCache()
+    {
+    if (! this->m_fLuxPending)
+        return;
+
+    bool fError;
+    float const lux = this->m_rawChannels.computeLux(fError);
+
+    this->m_fLuxPending = false;
+    this->m_fLuxCache = ! fError;
+    this->m_luxCache = lux;
+    }
+
+// protected
+bool Ltr_329als::isStatusDue(std::uint32_t now, bool &fError)
+    {
+    fError = false;
+
+    // wait at least until the sample should be ready.
+    if (now - this->m_startTime < this->m_delay)
+        {
+        // not yet
+        this->m_pollTime = now - 10;
+        return this->setLastError(Error::Busy);
+        }
+
+    // check the Als data status no more than every 10 ms.
+    if (now - this->m_pollTime < 10)
+        return this->setLastError(Error::Busy);
+
+    this->m_pollTime = now;
+    return true;
+    }
+
+// protected
+void Ltr_329als::commitSample(std::uint32_t now)
+    {
+    this->m_rawChannels = this->m_sample;
+    this->m_sampleTime = now;
+    this->m_fRawReported = false;
+    }
+
+// protected
+bool Ltr_329als::processHdrSample(std::uint32_t now)
+    {
+    // ALS_STATUS reports the gain each sample was taken with, so a
+    // sample that started before the last gain switch is still usable;
+    // file it by its own gain.
+    auto const gain = this->m_sample.getGain();
+    unsigned iGain;
+
+    if (gain == this->m_hdrGain[0])
+        iGain = 0;
+    else if (gain == this->m_hdrGain[1])
+        iGain = 1;
+    else
+        // taken before HDR mode started.
+        return false;
+
+    this->m_sample.updateQuality(gain);
+    this->m_hdrSample[iGain] = this->m_sample;
+    this->m_hdrFresh |= std::uint8_t(1u << iGain);
+
+    // ask for the other gain. If the next sample is already under way,
+    // this applies to the one after; either way, the gains alternate
+    // in pairs at worst, and a fused result is ready every two periods.
+    auto const nextGain = this->m_hdrGain[iGain ^ 1];
+    if (this->m_control.getGain() != nextGain)
+        {
+        this->m_control = this->m_control.setGain(nextGain);
+        if (! this->writeRegister(Register_t::ALS_CONTR, this->m_control.getValue()))
+            {
+            this->setState(State::Uninitialized);
+            return false;
+            }
+        }
+
+    this->m_startTime = now;
+
+    if (this->m_hdrFresh != 3)
+        return false;
+
+    // fuse: prefer the unsaturated sample with the most counts.
+    auto const &low = this->m_hdrSample[0];
+    auto const &high = this->m_hdrSample[1];
+
+    this->m_hdrFresh = 0;
+    if (! high.getQuality().getSaturated() && high.getTotalCounts() >= low.getTotalCounts())
+        {
+        this->m_hdrSelect = HdrSelect::High;
+        this->m_sample = high;
+        }
+    else
+        {
+        this->m_hdrSelect = low.getQuality().getSaturated() ? HdrSelect::Saturated : HdrSelect::Low;
+        this->m_sample = low;
+        }
+
+    return true;
+    }
+
+// protected
+bool Ltr_329als::processBurstSample(std::uint32_t now, bool &fError)
+    {
+    // the sample was taken with the configuration armed for it.
+    this->m_sample.setMeasRate(this->m_saveMeasRate);
+
+    // discard the sample that was under way when a queued change was
+    // written: the sensor may have started it with either configuration,
+    // and the status only shows the gain. Likewise, discard any sample
+    // taken before a gain change took effect. The next one is the first
+    // with the new configuration; its deadline runs from now.
+    if (this->m_fBurstDiscard || this->m_sample.getQuality().getGainMismatch())
+        {
+        this->m_fBurstDiscard = false;
+        this->m_startTime = now;
+        this->m_pollTime = now;
+        fError = false;
+        return this->setLastError(Error::Busy);
+        }
+
+    this->m_fHarvested = true;
+    this->commitSample(now);
+    ++this->m_burstCount;
+    this->m_burstTime = now;
+
+    if (--this->m_burstRemaining == 0)
+        {
+        // idle the device; changes state back to idle.
+        return this->setStandby();
+        }
+
+    // the next sample is due one measurement period from now.
+    ms_t period = this->m_saveMeasRate.getRate();
+
+    // re-arm for the next shot, applying any queued change.
+    if (this->m_fBurstConfig)
+        {
+        this->m_fBurstConfig = false;
+        this->m_userGain = this->m_burstGain;
+        this->m_control = this->m_control.setGain(this->m_burstGain);
+        this->m_measrate = this->m_measrate.setIntegration(this->m_burstIntegration);
+
+        auto const measrate = AlsMeasRate_t(this->m_measrate).setRate(this->m_burstIntegration);
+
+        // keep the configured rate, unless it's now too short.
+        if (this->m_measrate.getRate() < this->m_burstIntegration)
+            this->m_measrate = this->m_measrate.setRate(measrate.getRate());
+
+        if (! this->writeRegister(Register_t::ALS_MEAS_RATE, measrate.getValue()) ||
+            ! this->writeRegister(Register_t::ALS_CONTR, this->m_control.getValue()))
+            {
+            fError = true;
+            this->m_burstRemaining = 0;
+            this->setState(State::Uninitialized);
+            return false;
+            }
+
+        this->m_sensorMeasRate = measrate;
+        this->m_saveMeasRate = measrate;
+        this->m_fBurstDiscard = true;
+
+        // the sample under way still has the old period; keep the
+        // longer of the two until a sample with the new one arrives.
+        if (measrate.getRate() > period)
+            period = measrate.getRate();
+        }
+
+    this->m_startTime = now;
+    this->m_pollTime = now;
+    this->m_delay = period;
+    return true;
+    }
+
+// protected
+bool Ltr_329als::filterSample(std::uint32_t now)
+    {
+    auto const &sample = this->m_sample;
+    auto const &last = this->m_lastReported;
+    bool fReport;
+
+    if (this->m_fThresholds)
+        return this->filterThresholds();
+
+    if (! this->m_fDeadband || ! this->m_fReported)
+        fReport = true;
+    else if (this->m_maxSilence != 0 && now - this->m_lastReportTime >= this->m_maxSilence)
+        fReport = true;
+    else if (sample.getGain() != last.getGain() ||
+             sample.getIntegrationTime() != last.getIntegrationTime())
+        fReport = true;
+    else
+        {
+        // compare each channel against the larger of the two deadbands.
+        auto const outside = [this](std::uint16_t v, std::uint16_t ref) -> bool
+            {
+            std::uint32_t const delta = (v > ref) ? v - ref : ref - v;
+            std::uint32_t band = (std::uint32_t(ref) * this->m_deadbandRel) / 1000;
+
+            if (band < this->m_deadbandAbs)
+                band = this->m_deadbandAbs;
+
+            return delta > band;
+            };
+
+        fReport = outside(sample.getChan0(), last.getChan0()) ||
+                  outside(sample.getChan1(), last.getChan1());
+        }
+
+    if (! fReport)
+        {
+        ++this->m_nSuppressed;
+        return false;
+        }
+
+    this->m_lastReported = sample;
+    this->m_lastReportTime = now;
+    this->m_fReported = true;
+    return true;
+    }
+
+// protected
+bool Ltr_329als::filterThresholds()
+    {
+    std::uint16_t const ch0 = this->m_sample.getChan0();
+    std::uint16_t const low = this->m_thresholdLow;
+    std::uint16_t const high = this->m_thresholdHigh;
+    ThresholdEvent const zone = (low != 0 && ch0 < low)         ? ThresholdEvent::Below
+                              : (high != 0xFFFF && ch0 > high)  ? ThresholdEvent::Above
+                              :                                   ThresholdEvent::Inside
+                              ;
+    bool fReport = false;
+
+    if (zone == this->m_zone)
+        this->m_nPending = 0;
+    else if (this->m_zone == ThresholdEvent::None)
+        // first sample: report the initial zone immediately.
+        fReport = true;
+    else
+        {
+        if (zone != this->m_pendingZone)
+            {
+            this->m_pendingZone = zone;
+            this->m_nPending = 0;
+            }
+        if (++this->m_nPending >= this->m_persistence)
+            fReport = true;
+        }
+
+    if (fReport)
+        {
+        this->m_zone = zone;
+        this->m_thresholdEvent = zone;
+        this->m_nPending = 0;
+        }
+
+    // while far from both thresholds and not confirming a crossing,
+    // relax the poll rate by skipping samples.
+    if (this->m_nPending == 0)
+        {
+        std::uint32_t distance = 0xFFFFu;
+        std::uint32_t scale = 1;
+
+        if (low != 0)
+            {
+            distance = (ch0 > low) ? ch0 - low : low - ch0;
+            scale = low;
+            }
+        if (high != 0xFFFF)
+            {
+            std::uint32_t const dHigh = (ch0 > high) ? ch0 - high : high - ch0;
+            if (dHigh < distance)
+                {
+                distance = dHigh;
+                scale = high;
+                }
+            }
+
+        std::uint32_t const skip = (distance >= scale)      ? 8
+                                 : (2 * distance >= scale)  ? 4
+                                 : (4 * distance >= scale)  ? 2
+                                 :                            1
+                                 ;
+        this->m_delay *= skip;
+        }
+
+    if (! fReport)
+        ++this->m_nSuppressed;
+
+    return fReport;
+    }
+
 // protected
 bool Ltr_329als::readDataStatus()
     {
@@ -402,6 +1445,12 @@ bool Ltr_329als::readRegisters(Register_t r, std::uint8_t *pBuffer, size_t nBuff
     if (pBuffer == nullptr || nBuffer > 32)
         return this->setLastError(Error::InternalInvalidParameter);
 
+    if (this->m_pScheduler != nullptr)
+        {
+        std::uint8_t const reg = std::uint8_t(r);
+        return this->scheduledTransfer(&reg, 1, pBuffer, nBuffer);
+        }
+
     this->m_wire->beginTransmission(LTR_329ALS_PARAMS::Address);
     if (this->m_wire->write((uint8_t)r) != 1)
         {
@@ -409,11 +1458,14 @@ bool Ltr_329als::readRegisters(Register_t r, std::uint8_t *pBuffer, size_t nBuff
         }
     if (this->m_wire->endTransmission() != 0)
         {
+        this->accountTransfer(0);
         return this->setLastError(Error::I2cReadRequest);
         }
+    this->accountTransfer(1);
 
     auto nReadFrom = this->m_wire->requestFrom(LTR_329ALS_PARAMS::Address, std::uint8_t(nBuffer));
 
+    this->accountTransfer(nReadFrom);
     if (nReadFrom != nBuffer)
         return this->setLastError(Error::I2cReadRequest);
     auto const nResult = unsigned(this->m_wire->available());
@@ -434,22 +1486,126 @@ bool Ltr_329als::readRegisters(Register_t r, std::uint8_t *pBuffer, size_t nBuff
 bool Ltr_329als::writeRegister(Register_t r, std::uint8_t v)
     {
     const std::uint8_t cmdbuf[2] = { (std::uint8_t)r, v };
+
+    if (this->m_pScheduler != nullptr)
+        return this->scheduledTransfer(cmdbuf, sizeof(cmdbuf), nullptr, 0);
+
     this->m_wire->beginTransmission(LTR_329ALS_PARAMS::Address);
 
     if (this->m_wire->write(cmdbuf, sizeof(cmdbuf)) != sizeof(cmdbuf))
         return this->setLastError(Error::I2cWriteBufferFailed);
 
     if (this->m_wire->endTransmission() != 0)
+        {
+        this->accountTransfer(0);
+        return this->setLastError(Error::I2cWriteFailed);
+        }
+
+    this->accountTransfer(sizeof(cmdbuf));
+    return true;
+    }
+
+// protected
+bool Ltr_329als::writeRegisters(Register_t r, const std::uint8_t *pBuffer, size_t nBuffer)
+    {
+    if (pBuffer == nullptr || nBuffer > 31)
+        return this->setLastError(Error::InternalInvalidParameter);
+
+    if (this->m_pScheduler != nullptr)
+        {
+        std::uint8_t cmdbuf[32];
+
+        cmdbuf[0] = std::uint8_t(r);
+        memcpy(cmdbuf + 1, pBuffer, nBuffer);
+        return this->scheduledTransfer(cmdbuf, 1 + nBuffer, nullptr, 0);
+        }
+
+    this->m_wire->beginTransmission(LTR_329ALS_PARAMS::Address);
+
+    if (this->m_wire->write((std::uint8_t)r) != 1)
+        return this->setLastError(Error::I2cWriteBufferFailed);
+
+    if (this->m_wire->write(pBuffer, nBuffer) != nBuffer)
+        return this->setLastError(Error::I2cWriteBufferFailed);
+
+    if (this->m_wire->endTransmission() != 0)
+        {
+        this->accountTransfer(0);
         return this->setLastError(Error::I2cWriteFailed);
+        }
 
+    this->accountTransfer(1 + nBuffer);
     return true;
     }
 
+// protected
+void Ltr_329als::accountTransfer(size_t nBytes)
+    {
+    this->m_stats.nI2cTransfers += 1;
+    this->m_stats.nI2cBytes += nBytes;
+    if (this->m_pBusTiming != nullptr)
+        this->m_pBusTiming->addTransfer(nBytes);
+    }
+
+// protected
+bool Ltr_329als::scheduledTransfer(const std::uint8_t *pTx, size_t nTx, std::uint8_t *pRx, size_t nRx)
+    {
+    using Status = I2cScheduler_t::Status;
+    I2cScheduler_t::Transaction_t t;
+
+    t.pWire = this->m_wire;
+    t.address = LTR_329ALS_PARAMS::Address;
+    t.pTx = pTx;
+    t.nTx = std::uint8_t(nTx);
+    t.pRx = pRx;
+    t.nRx = std::uint8_t(nRx);
+    t.priority = this->m_schedulerPriority;
+
+    this->m_pScheduler->transfer(t);
+
+    // account for what reached the bus, as the direct path does: a
+    // write phase that isn't acknowledged counts as one transfer with no
+    // data; otherwise the write, then the bytes the read phase returned.
+    switch (t.status)
+        {
+    case Status::WriteFailed:
+        this->accountTransfer(0);
+        break;
+    case Status::Success:
+    case Status::ReadRequestFailed:
+    case Status::ReadShort:
+    case Status::ReadLong:
+        this->accountTransfer(nTx);
+        if (nRx != 0)
+            this->accountTransfer(t.nRxDone);
+        break;
+    default:
+        break;
+        }
+
+    switch (t.status)
+        {
+    case Status::Success:
+        return true;
+    case Status::WriteBufferFailed:
+        return this->setLastError(nRx != 0 ? Error::I2cReadRequest : Error::I2cWriteBufferFailed);
+    case Status::WriteFailed:
+        return this->setLastError(nRx != 0 ? Error::I2cReadRequest : Error::I2cWriteFailed);
+    case Status::ReadShort:
+        return this->setLastError(Error::I2cReadShort);
+    case Status::ReadLong:
+        return this->setLastError(Error::I2cReadLong);
+    case Status::ReadRequestFailed:
+    default:
+        return this->setLastError(Error::I2cReadRequest);
+        }
+    }
+
 /****************************************************************************\
 |   String handling for error routines
 \****************************************************************************/
 
-static const char *scanMultiSzString(const char *p, unsigned eIndex)
+const char *Mcci_Ltr_329als::scanMultiSzString(const char *p, unsigned eIndex)
     {
     // iterate based on error index.
     for (; eIndex > 0; --eIndex)
@@ -479,4 +1635,51 @@ const char * Ltr_329als::getStateName(Ltr_329als::State s)
     return scanMultiSzString(m_szStateNames, unsigned(s));
     }
 
+/****************************************************************************\
+|
+|   State-transition trace
+|
+\****************************************************************************/
+
+#if MCCI_LTR_329ALS_STATE_TRACE_DEPTH
+// protected
+void Ltr_329als::traceState(State s)
+    {
+    auto &entry = this->m_stateTrace[this->m_nStateTrace & (kStateTraceDepth - 1)];
+
+    entry.time = millis();
+    entry.oldState = this->m_state;
+    entry.newState = s;
+    entry.lastError = this->m_lastError;
+    entry.reserved = 0;
+    ++this->m_nStateTrace;
+    }
+#endif
+
+void Ltr_329als::dumpStateTrace(Print &out) const
+    {
+    WcetRecorder_t::Scope_t const wcet(this->m_pWcet, WcetRecorder_t::Method::DumpStateTrace);
+
+    StateTraceEntry_t entry;
+    unsigned age = this->getStateTraceCount();
+
+    if (age > kStateTraceDepth)
+        age = kStateTraceDepth;
+
+    while (age > 0)
+        {
+        if (! this->getStateTraceEntry(--age, entry))
+            continue;
+
+        out.print((unsigned long) entry.time);
+        out.print(" ");
+        out.print(getStateName(entry.oldState));
+        out.print(" -> ");
+        out.print(getStateName(entry.newState));
+        out.print(" (");
+        out.print(getErrorName(entry.lastError));
+        out.println(")");
+        }
+    }
+
 /**** end of mcci_ltr_329als.cpp ****/
@@ -24,6 +24,22 @@ Author:
 #include <cstdint>
 #include <Wire.h>
 #include "mcci_ltr_329als_regs.h"
+#include "mcci_ltr_329als_i2ctiming.h"
+#include "mcci_ltr_329als_i2csched.h"
+#include "mcci_ltr_329als_wcet.h"
+
+///
+/// \brief depth of the state-transition trace; 0 (the default) disables it.
+///
+/// \details
+///     Define this (e.g. with \c -DMCCI_LTR_329ALS_STATE_TRACE_DEPTH=32 in
+///     the build flags) to record each driver state change in a ring
+///     in the driver; see Ltr_329als::getStateTraceEntry(). It must be
+///     a power of two.
+///
+#ifndef MCCI_LTR_329ALS_STATE_TRACE_DEPTH
+# define MCCI_LTR_329ALS_STATE_TRACE_DEPTH 0
+#endif
 
 /// \brief namespace for this library
 namespace Mcci_Ltr_329als {
@@ -132,9 +148,25 @@ constexpr bool operator>=(const Version_t& lhs, const Version_t& rhs){ return !(
 constexpr bool operator!=(const Version_t& lhs, const Version_t& rhs){ return !(lhs == rhs); }
 
 
+///
+/// \brief look up a string in a multi-sz table.
+///
+/// \param [in] p points to the table: strings separated by \c '\\0',
+///     and ended by an empty string.
+/// \param [in] eIndex is the index of the string.
+///
+/// \return the string, or \c "<<unknown>>" if \p eIndex is out of range.
+///
+const char *scanMultiSzString(const char *p, unsigned eIndex);
+
+class Ltr_329alsGroup;
+
 /// \brief instance object for LTR-329als
 class Ltr_329als
     {
+    // a group uses broadcast writes on behalf of its members.
+    friend class Ltr_329alsGroup;
+
 public:
     /// \brief the version number for this version of the library.
     static constexpr Version_t kVersion = Version_t(1, 1, 0, 0);	/* v1.1.0 */
@@ -163,6 +195,11 @@ public:
     ///
     static constexpr AlsMeasRate_t::Rate_t kInitialMeasurementRate = 1000;
 
+    ///
+    /// \brief longest interval between readiness probes during begin(), in ms.
+    ///
+    static constexpr std::uint32_t kMaxProbeIntervalMs = 16;
+
 
     ///
     /// \brief Error codes
@@ -216,7 +253,7 @@ public:
         {
         Uninitialized,      ///< this->begin() has never succeeded.
         End,                ///< this->begin() succeeded, followed by this->end()
-        PowerOff,           ///< this->begin() succeeded, power is off.
+        PowerOff,           ///< startBegin() called, waiting for power-up.
         PowerOn,            ///< power on, delaying 100 ms.
         Initial,            ///< initial after begin (standby mode)
         Idle,               ///< idle (not measuring, active mode)
@@ -225,6 +262,102 @@ public:
         Ready,              ///< continuous measurement running, data availble.
         };
 
+    ///
+    /// \brief which sample of an HDR pair was used for the fused result
+    ///
+    /// \see startHdrMeasurement()
+    ///
+    enum class HdrSelect : std::uint8_t
+        {
+        None,               ///< no HDR result is available.
+        Low,                ///< the low-gain sample was used.
+        High,               ///< the high-gain sample was used.
+        Saturated,          ///< both samples saturated; the low-gain sample was used.
+        };
+
+    ///
+    /// \brief threshold window events
+    ///
+    /// \see setThresholds()
+    ///
+    enum class ThresholdEvent : std::uint8_t
+        {
+        None,               ///< no threshold event has been reported.
+        Inside,             ///< channel 0 entered the threshold window.
+        Above,              ///< channel 0 went above the upper threshold.
+        Below,              ///< channel 0 went below the lower threshold.
+        };
+
+    ///
+    /// \brief driver activity counters
+    ///
+    /// \details
+    ///     These are maintained by the driver so that applications
+    ///     and benchmarks can measure bus traffic and polling cost.
+    ///     An I2C transfer is one START ... STOP sequence; a register
+    ///     read takes two (one to set the register pointer, one to
+    ///     read the data).
+    ///
+    struct Statistics_t
+        {
+        std::uint32_t nPolls;           ///< number of calls to queryReady()
+        std::uint32_t nSamples;         ///< number of samples read from the sensor
+        std::uint32_t nI2cTransfers;    ///< number of I2C transfers
+        std::uint32_t nI2cBytes;        ///< number of bytes transferred, excluding address bytes
+        };
+
+    ///
+    /// \brief an entry in the state-transition trace
+    ///
+    /// \details
+    ///     One entry is recorded by setState() for each state change, if
+    ///     the trace is enabled with MCCI_LTR_329ALS_STATE_TRACE_DEPTH.
+    ///
+    struct StateTraceEntry_t
+        {
+        std::uint32_t time;             ///< millis() at the change
+        State oldState;                 ///< state before the change
+        State newState;                 ///< state after the change
+        Error lastError;                ///< last error at the change
+        std::uint8_t reserved;          ///< zero
+        };
+
+    /// \brief the number of entries kept in the state-transition trace.
+    static constexpr unsigned kStateTraceDepth = MCCI_LTR_329ALS_STATE_TRACE_DEPTH;
+
+    static_assert((kStateTraceDepth & (kStateTraceDepth - 1)) == 0,
+                  "MCCI_LTR_329ALS_STATE_TRACE_DEPTH must be a power of two");
+
+    ///
+    /// \brief driver state retained across MCU deep sleep
+    ///
+    /// \details
+    ///     Save this with saveState() in memory that survives deep sleep
+    ///     (RTC RAM, backup registers or FRAM), and pass it to resume()
+    ///     on wake instead of calling begin(). It holds the verified
+    ///     part and manufacturer IDs, the register shadows, and the
+    ///     configuration from configure(). The layout has no padding, so
+    ///     it may be stored as bytes; it is only meaningful to the same
+    ///     build of the library.
+    ///
+    struct RetainedState_t
+        {
+        std::uint32_t magic;            ///< kRetainedStateMagic if valid
+        std::uint16_t userRate;         ///< rate set by configure()
+        std::uint16_t userIntegration;  ///< integration time set by configure()
+        std::uint8_t control;           ///< shadow of \c ALS_CONTR (standby)
+        std::uint8_t measrate;          ///< shadow of \c ALS_MEAS_RATE from configure()
+        std::uint8_t sensorMeasRate;    ///< value last written to \c ALS_MEAS_RATE
+        std::uint8_t partid;            ///< verified \c PART_ID
+        std::uint8_t manufacid;         ///< verified \c MANUFAC_ID
+        std::uint8_t userGain;          ///< gain set by configure()
+        std::uint8_t reserved;          ///< zero
+        std::uint8_t check;             ///< check byte over the preceding bytes
+        };
+
+    /// \brief the magic number of a valid RetainedState_t.
+    static constexpr std::uint32_t kRetainedStateMagic = 0x4C545233u;
+
 private:
     /// \brief table of state names, '\0'-separated.
     ///
@@ -269,11 +402,92 @@ public:
     ///     \c true for success, \c false for failure (in which case the the last
     ///     error is set to the error reason).
     ///
+    /// \details
+    ///     This calls startBegin(), then polls queryBeginDone() until
+    ///     start-up is complete, calling \c yield() between polls.
+    ///
     bool begin();
 
+    ///
+    /// \brief start the driver without blocking.
+    ///
+    /// \return
+    ///     \c true if start-up has begun (or the driver is already
+    ///     running); poll queryBeginDone() until it's complete. \c false
+    ///     for failure (in which case the last error is set).
+    ///
+    /// \details
+    ///     This does the same work as begin(), but instead of waiting
+    ///     for the sensor to power up, reset and wake up, each call to
+    ///     queryBeginDone() makes at most one bus transfer and returns.
+    ///     Use this in loops that must not block, e.g. under a watchdog.
+    ///     Don't call other methods until queryBeginDone() returns \c true.
+    ///
+    bool startBegin();
+
+    ///
+    /// \brief advance start-up begun by startBegin().
+    ///
+    /// \param [out] fError is set \c true if start-up failed (the last
+    ///     error is then set, and the driver is not running).
+    ///
+    /// \return
+    ///     \c true once the driver is idle and ready for use.
+    ///
+    bool queryBeginDone(bool &fError);
+
+    ///
+    /// \brief save the driver state for a warm start after deep sleep.
+    ///
+    /// \param [out] state receives the retained state.
+    ///
+    /// \return
+    ///     \c true for success. \c false if the driver is not running or a
+    ///     measurement is in progress (in which case the last error is
+    ///     set). The sensor must be in standby, so that it does not need
+    ///     any attention while the MCU sleeps.
+    ///
+    bool saveState(RetainedState_t &state);
+
+    ///
+    /// \brief restart the driver from retained state, without a reset.
+    ///
+    /// \param [in] state is the state saved by saveState() before sleep.
+    ///
+    /// \return
+    ///     \c true for success, \c false for failure (in which case the
+    ///     last error is set).
+    ///
+    /// \details
+    ///     Use this instead of begin() after a deep sleep during which
+    ///     the sensor stayed powered. If \p state is valid, the sensor
+    ///     is checked with a single 3-byte read of \c ALS_MEAS_RATE,
+    ///     \c PART_ID and \c MANUFAC_ID; if these match, the register
+    ///     shadows are restored and the driver goes directly to
+    ///     State::Idle, skipping the reset and the start-up delays.
+    ///     If \p state is not valid, or the sensor does not answer or
+    ///     does not match it (for example because it lost power),
+    ///     resume() calls begin().
+    ///
+    bool resume(const RetainedState_t &state);
+
     /// \brief read product information
     bool readProductInfo(void);
 
+    ///
+    /// \brief return the time taken by the last successful begin(), in ms.
+    ///
+    /// \details
+    ///     This is the time from the start of begin() until the sensor
+    ///     was ready, including the probes for the sensor to come out
+    ///     of power-on and reset. It is zero if the driver was started
+    ///     by resume().
+    ///
+    std::uint32_t getBootTimeMs() const
+        {
+        return this->m_bootTime;
+        }
+
     /// \brief configure measurement
     bool configure(AlsGain_t::Gain_t g, AlsMeasRate_t::Rate_t r, AlsMeasRate_t::Integration_t iTime);
 
@@ -317,6 +531,187 @@ public:
     /// \brief start a single measurement.
     bool startMeasurement(bool fSingle = true);
 
+    ///
+    /// \brief start continuous HDR measurements, alternating gains
+    ///
+    /// \param [in] lowGain is the gain to use for the low-gain sample.
+    /// \param [in] highGain is the gain to use for the high-gain sample;
+    ///     it must be greater than \p lowGain.
+    ///
+    /// \return
+    ///     \c true for success, \c false for failure (in which case the
+    ///     last error is set).
+    ///
+    /// \details
+    ///     The sensor is put into continuous mode, and the gain in
+    ///     \c ALS_CONTR is switched each time a sample is harvested.
+    ///     Each sample is used at the gain it was taken with, including
+    ///     the one already under way when the gain is switched, so
+    ///     queryReady() returns \c true once every two measurement
+    ///     periods (the first result may take three), and each result
+    ///     is at most two periods old. The raw
+    ///     data is then the sample with the best signal-to-noise ratio
+    ///     that is not saturated. Use getHdrSelection() to find out which sample was
+    ///     chosen. The integration time and rate are those set by
+    ///     configure(). Use stopMeasurement() to leave HDR mode.
+    ///
+    bool startHdrMeasurement(AlsGain_t::Gain_t lowGain, AlsGain_t::Gain_t highGain);
+
+    /// \brief return which sample was used for the most recent HDR result.
+    HdrSelect getHdrSelection() const
+        {
+        return this->m_hdrSelect;
+        }
+
+    /// \brief stop an ongoing single, continuous or HDR measurement.
+    bool stopMeasurement();
+
+    ///
+    /// \brief start a burst of back-to-back single measurements.
+    ///
+    /// \param [in] nSamples is the number of samples to take.
+    ///
+    /// \return
+    ///     \c true for success, \c false for failure (in which case the
+    ///     last error is set).
+    ///
+    /// \details
+    ///     The sensor runs with the gain and integration time set by
+    ///     configure(), as fast as the integration time allows. Poll
+    ///     queryReady() as for a single measurement; it returns \c true
+    ///     once for each sample, and the sensor is put into standby
+    ///     after the last one. The state is State::Single throughout.
+    ///
+    bool startBurst(std::uint16_t nSamples);
+
+    ///
+    /// \brief change the configuration between shots of a burst.
+    ///
+    /// \param [in] g is the gain for the following samples.
+    /// \param [in] iTime is the integration time for the following samples.
+    ///
+    /// \return \c true for success, \c false for failure.
+    ///
+    /// \details
+    ///     The change is written to the sensor by queryReady() when it
+    ///     harvests the next sample, with the rate set as short as
+    ///     \p iTime allows. The new values also replace those set by
+    ///     configure(); if \p iTime is longer than the configured rate,
+    ///     the rate is raised to the burst rate.
+    ///
+    ///     The sample under way when the change is written may have
+    ///     been started with either configuration, so it's discarded;
+    ///     each change costs one sample period.
+    ///
+    bool queueBurstConfig(AlsGain_t::Gain_t g, AlsMeasRate_t::Integration_t iTime);
+
+    /// \brief return the number of samples remaining in the current burst.
+    std::uint16_t getBurstRemaining() const
+        {
+        return this->m_burstRemaining;
+        }
+
+    ///
+    /// \brief return the sample rate achieved by the most recent burst.
+    ///
+    /// \return
+    ///     samples per second, times 1000, measured from the start of the
+    ///     burst to the last sample harvested.
+    ///
+    std::uint32_t getBurstRateMilliHz() const;
+
+    ///
+    /// \brief enable change-only reporting in continuous mode.
+    ///
+    /// \param [in] absCounts is the absolute deadband, in counts.
+    /// \param [in] relPermille is the relative deadband, in parts per
+    ///     thousand of the last reported value.
+    /// \param [in] maxSilenceMs is the longest time without a report;
+    ///     zero means no heartbeat.
+    ///
+    /// \return \c true for success, \c false if both deadbands are zero.
+    ///
+    /// \details
+    ///     In continuous (and HDR) mode, a sample is reported by
+    ///     queryReady() only if either channel differs from the last
+    ///     reported sample by more than the larger of the two
+    ///     deadbands, or if the gain or integration time changed, or if
+    ///     \p maxSilenceMs has elapsed since the last report. Other
+    ///     samples are suppressed: queryReady() returns \c false with
+    ///     no error, just as if the sample were not yet ready. The
+    ///     first sample after starting is always reported. Single
+    ///     measurements are not affected.
+    ///
+    bool setDeadband(std::uint16_t absCounts, std::uint16_t relPermille, std::uint32_t maxSilenceMs);
+
+    /// \brief disable change-only reporting.
+    void clearDeadband()
+        {
+        this->m_fDeadband = false;
+        }
+
+    ///
+    /// \brief emulate threshold interrupts in continuous mode.
+    ///
+    /// \param [in] lower is the lower threshold, in channel 0 counts;
+    ///     zero means no lower threshold.
+    /// \param [in] upper is the upper threshold, in channel 0 counts;
+    ///     0xFFFF means no upper threshold.
+    /// \param [in] persistence is the number of consecutive samples that
+    ///     must be in a new zone before a crossing is reported, in [1, 16].
+    ///
+    /// \return \c true for success, \c false for invalid parameters.
+    ///
+    /// \details
+    ///     The LTR-329ALS has no threshold registers or interrupt pin,
+    ///     so the window is evaluated by queryReady() as each
+    ///     continuous sample arrives. Like the hardware thresholds of
+    ///     related parts, the comparison uses raw channel 0 counts, so
+    ///     thresholds are specific to the configured gain and
+    ///     integration time. Only crossings are reported:
+    ///     queryReady() returns \c true when the first sample is seen
+    ///     (to establish the initial zone) and when the zone changes;
+    ///     all other samples are suppressed as if not yet ready. Use
+    ///     getThresholdEvent() to find out what happened.
+    ///
+    ///     While channel 0 is far from both thresholds, the driver skips
+    ///     samples (up to 8 measurement periods) instead of reading
+    ///     every one; see getPollIntervalMs(). Persistence counts
+    ///     the samples that are actually read.
+    ///
+    ///     When thresholds are enabled, the deadband set by
+    ///     setDeadband() is not used.
+    ///
+    bool setThresholds(std::uint16_t lower, std::uint16_t upper, std::uint8_t persistence = 1);
+
+    /// \brief disable threshold emulation.
+    void clearThresholds()
+        {
+        this->m_fThresholds = false;
+        }
+
+    /// \brief return the event that caused the last threshold report.
+    ThresholdEvent getThresholdEvent() const
+        {
+        return this->m_thresholdEvent;
+        }
+
+    ///
+    /// \brief return the time until the driver next needs to be polled.
+    ///
+    /// \return
+    ///     the number of milliseconds until queryReady() will next talk
+    ///     to the sensor, or zero if it should be called right away. The
+    ///     caller may sleep this long without losing anything.
+    ///
+    std::uint32_t getPollIntervalMs() const;
+
+    /// \brief return the number of samples suppressed by deadband or threshold filtering.
+    std::uint32_t getSuppressedCount() const
+        {
+        return this->m_nSuppressed;
+        }
+
     ///
     /// \brief find out whether a measurement is ready
     ///
@@ -360,6 +755,32 @@ public:
     ///
     float getLux();
 
+    ///
+    /// \brief get lux no older than a given age, measuring if needed.
+    ///
+    /// \param [in] maxAgeMs is the oldest acceptable sample, in ms.
+    /// \param [out] lux is set to the light level, if the result is \c true.
+    /// \param [out] fError is set \c true if a hard error occurred.
+    ///
+    /// \return
+    ///     \c true if \p lux was set. \c false if the value isn't ready
+    ///     yet (call again later), or on error.
+    ///
+    /// \details
+    ///     If the last reported sample is fresh enough, its lux value
+    ///     is returned from a cache. Otherwise a single measurement is
+    ///     started if the driver is idle, or the measurement already
+    ///     running is joined, so that several independent callers
+    ///     share one measurement. Poll this like queryReady().
+    ///
+    ///     Joining doesn't take the sample from the caller that
+    ///     started the measurement: that caller's next queryReady()
+    ///     still returns \c true for it. Samples suppressed by
+    ///     setDeadband() or setThresholds() are used here, though they
+    ///     are not reported.
+    ///
+    bool getLux(std::uint32_t maxAgeMs, float &lux, bool &fError);
+
     /// \brief reset and stop any ongoing measurement
     bool reset();
 
@@ -406,6 +827,134 @@ public:
         return getErrorName(this->m_lastError);
         }
 
+    /// \brief return the activity counters.
+    const Statistics_t &getStatistics() const
+        {
+        return this->m_stats;
+        }
+
+    /// \brief reset the activity counters to zero.
+    void resetStatistics()
+        {
+        this->m_stats = Statistics_t {};
+        }
+
+    ///
+    /// \brief return the number of state changes traced.
+    ///
+    /// \return the number of changes since the trace was cleared; only
+    ///     the newest kStateTraceDepth are kept. Always zero if the
+    ///     trace is disabled.
+    ///
+    std::uint32_t getStateTraceCount() const
+        {
+#if MCCI_LTR_329ALS_STATE_TRACE_DEPTH
+        return this->m_nStateTrace;
+#else
+        return 0;
+#endif
+        }
+
+    ///
+    /// \brief return an entry from the state-transition trace.
+    ///
+    /// \param [in] age is 0 for the newest entry, 1 for the one before, ...
+    /// \param [out] entry receives the entry.
+    ///
+    /// \return \c true for success, \c false if there is no such entry.
+    ///
+    bool getStateTraceEntry(unsigned age, StateTraceEntry_t &entry) const
+        {
+#if MCCI_LTR_329ALS_STATE_TRACE_DEPTH
+        if (age >= kStateTraceDepth || age >= this->m_nStateTrace)
+            return false;
+
+        entry = this->m_stateTrace[(this->m_nStateTrace - 1 - age) & (kStateTraceDepth - 1)];
+        return true;
+#else
+        (void) age;
+        (void) entry;
+        return false;
+#endif
+        }
+
+    /// \brief clear the state-transition trace.
+    void clearStateTrace()
+        {
+#if MCCI_LTR_329ALS_STATE_TRACE_DEPTH
+        this->m_nStateTrace = 0;
+#endif
+        }
+
+    ///
+    /// \brief print the state-transition trace, oldest first.
+    ///
+    /// \param [in] out is where to print, e.g. \c Serial.
+    ///
+    /// \details
+    ///     Each line has the time, the old and new states, and the last
+    ///     error. Call this when timing no longer matters, e.g. after an
+    ///     error has been detected.
+    ///
+    void dumpStateTrace(Print &out) const;
+
+    ///
+    /// \brief attach a bus timing model.
+    ///
+    /// \param [in] pTiming points to the model, or is \c nullptr to detach.
+    ///
+    /// \details
+    ///     Each I2C transfer made by this driver is added to the model,
+    ///     so the model's occupancy tracks the bus time used by this
+    ///     sensor. A transfer that is not acknowledged is added as
+    ///     the address byte only. Several drivers (and other bus clients) may share
+    ///     one model to account for the total load on a bus.
+    ///
+    void setBusTiming(I2cBusTiming_t *pTiming)
+        {
+        this->m_pBusTiming = pTiming;
+        }
+
+    ///
+    /// \brief send register transfers through a shared-bus scheduler.
+    ///
+    /// \param [in] pScheduler points to the scheduler, or is \c nullptr
+    ///     to talk to the bus directly.
+    /// \param [in] priority is the priority of this driver's transfers.
+    ///
+    /// \details
+    ///     The driver's transfers are run synchronously with
+    ///     I2cScheduler_t::transfer(), so more urgent work queued by
+    ///     other clients of the bus runs first.
+    ///
+    void setScheduler(I2cScheduler_t *pScheduler, std::uint8_t priority = 0)
+        {
+        this->m_pScheduler = pScheduler;
+        this->m_schedulerPriority = priority;
+        }
+
+    ///
+    /// \brief attach an execution time recorder.
+    ///
+    /// \param [in] pRecorder points to the recorder, or is \c nullptr
+    ///     to detach.
+    ///
+    /// \details
+    ///     The execution time of each public method that is not
+    ///     defined inline is recorded; see WcetRecorder_t for the
+    ///     methods.
+    ///
+    void setWcetRecorder(WcetRecorder_t *pRecorder)
+        {
+        this->m_pWcet = pRecorder;
+        }
+
+    /// \brief return the execution time recorder, or \c nullptr.
+    WcetRecorder_t *getWcetRecorder() const
+        {
+        return this->m_pWcet;
+        }
+
     /// \brief return a const reference to the data regs
     const DataRegs_t &getRawData() const
         {
@@ -428,9 +977,17 @@ protected:
     ///
     virtual void setState(State s)
         {
+#if MCCI_LTR_329ALS_STATE_TRACE_DEPTH
+        this->traceState(s);
+#endif
         this->m_state = s;
         }
 
+#if MCCI_LTR_329ALS_STATE_TRACE_DEPTH
+    /// \brief record a state change in the trace.
+    void traceState(State s);
+#endif
+
     ///
     /// \brief Make sure the driver is running
     ///
@@ -503,27 +1060,286 @@ protected:
     ///
     bool readDataStatus();
 
+    ///
+    /// \brief run a register transfer through the scheduler.
+    ///
+    /// \param [in] pTx points to the bytes to write (register address first).
+    /// \param [in] nTx is the number of bytes to write.
+    /// \param [out] pRx points to the buffer for bytes read, if any.
+    /// \param [in] nRx is the number of bytes to read.
+    ///
+    /// \return
+    ///     \c true for success, \c false for failure. The
+    ///     last error is set in case of error.
+    ///
+    bool scheduledTransfer(const std::uint8_t *pTx, size_t nTx, std::uint8_t *pRx, size_t nRx);
+
+    ///
+    /// \brief count a transfer that reached the bus.
+    ///
+    /// \param [in] nBytes is the number of data bytes transferred. A
+    ///     transfer that was not acknowledged is counted with zero
+    ///     bytes, as only the address went on the bus.
+    ///
+    void accountTransfer(size_t nBytes);
+
+    ///
+    /// \brief put the sensor in active mode and start measuring.
+    ///
+    /// \param [in] measrate is the value to write to \c ALS_MEAS_RATE.
+    /// \param [in] newState is the state to enter (State::Single or
+    ///     State::Continuous).
+    ///
+    /// \return
+    ///     \c true for success, \c false for failure. The
+    ///     last error is set in case of error.
+    ///
+    bool activate(AlsMeasRate_t measrate, State newState);
+
+    ///
+    /// \brief update the driver for a measurement that has been started.
+    ///
+    /// \param [in] measrate is the value written to \c ALS_MEAS_RATE.
+    /// \param [in] newState is the state to enter.
+    /// \param [in] now is the time at which \c ALS_CONTR was written.
+    ///
+    /// \details
+    ///     This is the bookkeeping part of activate(), without any bus
+    ///     traffic. It is also used when the sensor was started by a
+    ///     broadcast write on behalf of several drivers.
+    ///
+    void markActive(AlsMeasRate_t measrate, State newState, std::uint32_t now);
+
+    ///
+    /// \brief decide whether it's time to read \c ALS_STATUS
+    ///
+    /// \param [in] now is the current time.
+    /// \param [out] fError is set \c true if a hard error occurred.
+    ///
+    /// \return
+    ///     \c true if queryReady() should read the status register now.
+    ///     Otherwise \c false, and the last error is set (to Error::Busy
+    ///     if no hard error occurred).
+    ///
+    /// \details
+    ///     The default implementation waits until the sample is due,
+    ///     then polls no more than once every 10 ms. Drivers for parts
+    ///     with an interrupt line override this to avoid polling.
+    ///
+    virtual bool isStatusDue(std::uint32_t now, bool &fError);
+
+    /// \brief return \c true if the current measurement has timed out.
+    bool isTimedOut(std::uint32_t now) const
+        {
+        return now - this->m_startTime > 2 * this->m_delay;
+        }
+
+    ///
+    /// \brief write a series of bytes starting with a given register.
+    ///
+    /// \param [in] r indicates the starting register to be written.
+    /// \param [in] pBuffer points to the data to be written
+    /// \param [in] nBuffer is the number of bytes to write.
+    ///
+    /// \return
+    ///     \c true for success, \c false for failure. The
+    ///     last error is set in case of error.
+    ///
+    bool writeRegisters(Register_t r, const std::uint8_t *pBuffer, size_t nBuffer);
+
+    ///
+    /// \brief advance the measurement engine; the body of queryReady().
+    ///
+    /// \param [out] fError is set \c true if a hard error occurred.
+    ///
+    /// \return \c true if a sample is ready to be reported.
+    ///
+    bool pollMeasurement(bool &fError);
+
+    /// \brief convert the last reported sample to lux, if not done already.
+    void updateLuxCache();
+
+    /// \brief record that the sample in \refitem m_rawChannels has been reported.
+    void markReported();
+
+    ///
+    /// \brief make the harvested sample in \refitem m_sample the current result.
+    ///
+    /// \param [in] now is the time at which the sample was read.
+    ///
+    void commitSample(std::uint32_t now);
+
+    ///
+    /// \brief process an HDR sample that has been read into \refitem m_sample.
+    ///
+    /// \param [in] now is the time at which the sample was read.
+    ///
+    /// \return
+    ///     \c true if the pair is complete and a fused result is in
+    ///     \refitem m_sample, \c false if another sample is
+    ///     needed. In the latter case, if a bus error occurs the
+    ///     state is changed to State::Uninitialized.
+    ///
+    bool processHdrSample(std::uint32_t now);
+
+    ///
+    /// \brief process a sample harvested during a burst.
+    ///
+    /// \param [in] now is the time at which the sample was read.
+    /// \param [out] fError is set \c true if a hard error occurred.
+    ///
+    /// \return
+    ///     \c true if the sample should be reported to the caller.
+    ///
+    bool processBurstSample(std::uint32_t now, bool &fError);
+
+    ///
+    /// \brief decide whether the sample in \refitem m_sample is reported.
+    ///
+    /// \details
+    ///     A suppressed sample is dropped; \refitem m_rawChannels keeps
+    ///     the last reported one.
+    ///
+    /// \param [in] now is the time at which the sample was read.
+    ///
+    /// \return
+    ///     \c true if the sample should be reported to the caller, \c false
+    ///     if it is suppressed.
+    ///
+    bool filterSample(std::uint32_t now);
+
+    ///
+    /// \brief apply threshold emulation to the sample in \refitem m_sample.
+    ///
+    /// \return
+    ///     \c true if the sample is a crossing that should be reported.
+    ///
+    bool filterThresholds();
+
+    ///
+    /// \brief read \c PART_ID once, and check it.
+    ///
+    /// \return
+    ///     \c true if the sensor answered with the right part number;
+    ///     otherwise \c false, with the last error set.
+    ///
+    bool probeOnce();
+
+    ///
+    /// \brief enter State::Initial after reset, and set up the initial
+    ///     configuration.
+    ///
+    /// \return
+    ///     \c true for success; the wakeup delay then runs from now.
+    ///     \c false for failure, in which case the driver is
+    ///     uninitialized and the last error is set.
+    ///
+    /// \details
+    ///     Every start-up path calls this once the sensor is out of
+    ///     reset, so derived classes override it to set up their
+    ///     additional registers.
+    ///
+    virtual bool beginInitial();
+
+    /// \brief return \c true if queryBeginDone() has nothing to do yet.
+    bool isBeginWaiting(ms_t now) const
+        {
+        return std::uint32_t(now - this->m_startTime) < this->m_delay;
+        }
+
+    /// \brief compute the check byte of a RetainedState_t.
+    static std::uint8_t computeRetainedCheck(const RetainedState_t &state);
+
+private:
+    ///
+    /// \brief end the bookkeeping of a running measurement.
+    ///
+    /// \return
+    ///     \c true if a measurement was running; the sensor must then be
+    ///     put in standby. \c false if there is nothing to stop.
+    ///
+    /// \details
+    ///     The gain set by configure() is restored after HDR mode, and
+    ///     any burst and pending report are dropped. This is shared by
+    ///     stopMeasurement() and Ltr_329alsGroup::stopMeasurement(),
+    ///     which puts several sensors in standby with one write.
+    ///
+    bool prepareStop();
+
     //
     // The local variables
     //
 private:
     TwoWire     *m_wire;                ///< pointer to I2C bus
+    Statistics_t m_stats {};            ///< activity counters
+    I2cBusTiming_t *m_pBusTiming = nullptr; ///< optional bus timing model
+    I2cScheduler_t *m_pScheduler = nullptr; ///< optional shared-bus scheduler
+    WcetRecorder_t *m_pWcet = nullptr;      ///< optional execution time recorder
+    std::uint8_t m_schedulerPriority = 0;   ///< priority of transfers via m_pScheduler
     AlsGain_t::Gain_t m_userGain;       ///< user-requested gain
     AlsMeasRate_t::Integration_t m_userIntegration;     ///< user-reqeusted integration period
     AlsMeasRate_t::Rate_t m_userRate;   ///< user-reqeusted measurement repeat rate
     ms_t        m_startTime;            ///< when the last measurement was started
     ms_t        m_pollTime;             ///< last time mesurement was polled
     ms_t        m_delay;                ///< ms to delay
+    ms_t        m_bootTime = 0;         ///< ms taken by the last begin()
+#if MCCI_LTR_329ALS_STATE_TRACE_DEPTH
+    StateTraceEntry_t m_stateTrace[kStateTraceDepth];   ///< state-transition trace ring
+    std::uint32_t m_nStateTrace = 0;    ///< number of state changes traced
+#endif
+    ms_t        m_beginTime;            ///< when startBegin() was called
+    ms_t        m_probeInterval;        ///< current startBegin() probe interval
     Error       m_lastError;            ///< last error
-    State       m_state;                ///< state of measurement engine
+    State       m_state = State::Uninitialized; ///< state of measurement engine
     AlsContr_t  m_control;              ///< control register
     AlsMeasRate_t m_measrate;               ///< rate/integration register
+    AlsMeasRate_t m_sensorMeasRate;     ///< value last written to ALS_MEAS_RATE
     AlsStatus_t m_status;               ///< status register
     DataRegs_t  m_rawChannels;          ///< last raw data result.
+    DataRegs_t  m_sample;               ///< sample being harvested
+    ms_t        m_harvestTime = 0;      ///< when m_sample was read
+    ms_t        m_sampleTime = 0;       ///< when m_rawChannels was read
+    ms_t        m_luxTime = 0;          ///< when the sample for m_luxCache was read
+    float       m_luxCache = 0.0f;      ///< lux of the last reported sample
+    bool        m_fLuxCache = false;    ///< true if m_luxCache is valid
+    bool        m_fLuxPending = false;  ///< true if a reported sample is not yet converted
+    bool        m_fRawReported = false; ///< true if m_rawChannels holds the last reported sample
+    bool        m_fHarvested = false;   ///< true if the last poll harvested a complete sample into m_sample
+    bool        m_fReportPending = false;   ///< true if getLux(maxAge) harvested a sample for another caller
+    bool        m_fLuxSingle = false;   ///< true if getLux(maxAge) started the single measurement
     AlsStatus_t  m_saveStatus;          ///< status from last measurement
-    AlsMeasRate_t m_saveMeasRate;       ///< AlsMeasRate_t from last measurement
+    AlsMeasRate_t m_saveMeasRate;       ///< AlsMeasRate_t armed for the next burst sample
     PartID_t    m_partid;               ///< part id register
     ManufacID_t m_manufacid;            ///< manufacturer id register
+    DataRegs_t  m_hdrSample[2];         ///< latest HDR samples, low gain then high
+    AlsGain_t::Gain_t m_hdrGain[2];     ///< HDR gains, low then high
+    std::uint8_t m_hdrFresh;            ///< bit i set if m_hdrSample[i] is not yet fused
+    bool        m_fHdr = false;         ///< true if running in HDR mode
+    HdrSelect   m_hdrSelect = HdrSelect::None;  ///< sample chosen for last HDR result
+    DataRegs_t  m_lastReported;         ///< last sample reported in continuous mode
+    ms_t        m_lastReportTime;       ///< when m_lastReported was reported
+    std::uint32_t m_maxSilence;         ///< max ms between reports; zero for no limit
+    std::uint32_t m_nSuppressed = 0;    ///< number of samples suppressed
+    std::uint16_t m_deadbandAbs;        ///< absolute deadband, in counts
+    std::uint16_t m_deadbandRel;        ///< relative deadband, in permille
+    bool        m_fDeadband = false;    ///< true if deadband filtering is enabled
+    bool        m_fReported = false;    ///< true if m_lastReported is valid
+    std::uint16_t m_thresholdLow;       ///< lower threshold, channel 0 counts
+    std::uint16_t m_thresholdHigh;      ///< upper threshold, channel 0 counts
+    std::uint8_t m_persistence;         ///< samples needed to confirm a crossing
+    std::uint8_t m_nPending;            ///< samples seen in m_pendingZone
+    ThresholdEvent m_zone;              ///< current confirmed zone
+    ThresholdEvent m_pendingZone;       ///< candidate new zone
+    ThresholdEvent m_thresholdEvent = ThresholdEvent::None; ///< last reported event
+    bool        m_fThresholds = false;  ///< true if threshold emulation is enabled
+    ms_t        m_burstStartTime = 0;   ///< when the current burst started
+    ms_t        m_burstTime = 0;        ///< when the last burst sample was harvested
+    std::uint16_t m_burstRemaining = 0; ///< samples remaining in the current burst
+    std::uint16_t m_burstCount = 0;     ///< samples harvested in the current burst
+    AlsGain_t::Gain_t m_burstGain;      ///< queued gain for the next burst shot
+    AlsMeasRate_t::Integration_t m_burstIntegration;    ///< queued integration time
+    bool        m_fBurstConfig = false; ///< true if a burst configuration change is queued
+    bool        m_fBurstDiscard = false;    ///< true if the next burst sample may predate a configuration change
     };
 
 } // end namespace Mcci_Ltr_329als
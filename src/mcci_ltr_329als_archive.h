@@ -0,0 +1,431 @@
+/*
+
+Module: mcci_ltr_329als_archive.h
+
+Function:
+    Memory-mapped reader for LTR-329ALS sample archives (host only).
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+/// \file
+///
+/// This header is for POSIX hosts (gateways and analysis machines),
+/// not for Arduino targets. It is entirely inline; include it from a
+/// host program and compile with the library's \c src directory on the
+/// include path. No library \c .cpp files are needed.
+///
+
+#ifndef _mcci_ltr_329als_archive_h_
+#define _mcci_ltr_329als_archive_h_ /* prevent multiple includes */
+
+#pragma once
+
+#if defined(ARDUINO)
+# error "mcci_ltr_329als_archive.h is for host programs only"
+#endif
+
+#include "mcci_ltr_329als_store.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Mcci_Ltr_329als {
+
+///
+/// \brief A record in an archive, viewed in place.
+///
+/// \details
+///     The layout is that written by SampleStore_t: timestamp (4 bytes,
+///     little-endian), the four data registers in I2C order, the status
+///     and meas/rate registers, a CRC-8 and a commit marker. The type
+///     has byte alignment, so pointers into a mapped file are valid.
+///
+struct ArchiveRecord_t
+    {
+    std::uint8_t    bytes[SampleStore_t::kRecordSize];  ///< the raw record
+
+    /// \brief return the timestamp.
+    std::uint32_t getTimestamp() const
+        {
+        return std::uint32_t(this->bytes[0]) | (std::uint32_t(this->bytes[1]) << 8) |
+               (std::uint32_t(this->bytes[2]) << 16) | (std::uint32_t(this->bytes[3]) << 24);
+        }
+
+    /// \brief return the value of channel 0.
+    std::uint16_t getChan0() const
+        {
+        return (this->bytes[7] << 8) | this->bytes[6];
+        }
+
+    /// \brief return the value of channel 1.
+    std::uint16_t getChan1() const
+        {
+        return (this->bytes[5] << 8) | this->bytes[4];
+        }
+
+    /// \brief return the image of the status register.
+    AlsStatus_t getStatus() const
+        {
+        return AlsStatus_t(this->bytes[8]);
+        }
+
+    /// \brief return the image of the meas/rate register.
+    AlsMeasRate_t getMeasRate() const
+        {
+        return AlsMeasRate_t(this->bytes[9]);
+        }
+
+    /// \brief return \c true if the record was completely written.
+    bool isCommitted() const
+        {
+        return this->bytes[SampleStore_t::kRecordSize - 1] == SampleStore_t::kCommit;
+        }
+
+    /// \brief return the record as a DataRegs_t.
+    DataRegs_t getDataRegs() const
+        {
+        DataRegs_t result;
+
+        std::memcpy(result.getDataPointer(), this->bytes + 4, result.getDataSize());
+        result.setStatus(this->getStatus());
+        result.setMeasRate(this->getMeasRate());
+        return result;
+        }
+    };
+
+static_assert(sizeof(ArchiveRecord_t) == SampleStore_t::kRecordSize, "ArchiveRecord_t must be packed");
+
+///
+/// \brief Read-only, memory-mapped view of a SampleStore_t image.
+///
+/// \details
+///     An archive is a file holding the backend image of a
+///     SampleStore_t, e.g. copied from a device's FRAM or flash. open()
+///     maps the file and orders its segments by sequence number; the
+///     records can then be walked in place, either one at a time with
+///     next() or a segment at a time with getSpan(), which hands back a
+///     pointer into the mapping.
+///
+///     convertLux() converts a span of records to lux in bulk. It uses
+///     the DataRegs_t lux coefficients, but is written without branches
+///     so that the compiler can vectorize it.
+///
+class SampleArchive_t
+    {
+public:
+    /// \brief a run of contiguous records in the mapping.
+    struct Span_t
+        {
+        const ArchiveRecord_t  *pRecords;   ///< first record
+        std::size_t             nRecords;   ///< number of records
+        };
+
+    /// \brief a position in the archive, for iteration.
+    struct Cursor_t
+        {
+        std::size_t     segment;            ///< index into the ordered segments
+        std::size_t     slot;               ///< record within the segment
+        };
+
+    SampleArchive_t() = default;
+
+    ~SampleArchive_t()
+        {
+        this->close();
+        }
+
+    // neither copyable nor movable
+    SampleArchive_t(const SampleArchive_t&) = delete;
+    SampleArchive_t& operator=(const SampleArchive_t&) = delete;
+    SampleArchive_t(const SampleArchive_t&&) = delete;
+    SampleArchive_t& operator=(const SampleArchive_t&&) = delete;
+
+    ///
+    /// \brief map an archive file.
+    ///
+    /// \param [in] pPath is the name of the file.
+    /// \param [in] segmentSize is the segment size of the device's
+    ///     backend (SampleStoreBackend_t::getSegmentSize()).
+    ///
+    /// \return \c true if the file was mapped and has at least one
+    ///     valid segment.
+    ///
+    bool open(const char *pPath, std::uint32_t segmentSize)
+        {
+        this->close();
+
+        if (segmentSize < SampleStore_t::kHeaderSize + SampleStore_t::kRecordSize)
+            return false;
+
+        int const fd = ::open(pPath, O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size < off_t(segmentSize))
+            {
+            ::close(fd);
+            return false;
+            }
+
+        void *const pMap = ::mmap(nullptr, std::size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (pMap == MAP_FAILED)
+            return false;
+
+        // we read each segment front to back.
+        ::madvise(pMap, std::size_t(st.st_size), MADV_SEQUENTIAL);
+
+        this->m_pBase = static_cast<const std::uint8_t *>(pMap);
+        this->m_nBase = std::size_t(st.st_size);
+        this->m_segmentSize = segmentSize;
+        this->scan();
+
+        return ! this->m_segments.empty();
+        }
+
+    /// \brief unmap the archive.
+    void close()
+        {
+        if (this->m_pBase != nullptr)
+            ::munmap(const_cast<std::uint8_t *>(this->m_pBase), this->m_nBase);
+
+        this->m_pBase = nullptr;
+        this->m_nBase = 0;
+        this->m_segments.clear();
+        }
+
+    /// \brief return the number of segments holding data.
+    std::size_t getSegmentCount() const
+        {
+        return this->m_segments.size();
+        }
+
+    /// \brief return the written records of a segment (oldest first).
+    Span_t getSpan(std::size_t segment) const
+        {
+        if (segment >= this->m_segments.size())
+            return Span_t { nullptr, 0 };
+
+        auto const &s = this->m_segments[segment];
+        return Span_t { s.pRecords, s.nRecords };
+        }
+
+    /// \brief position a cursor at the oldest record.
+    void rewind(Cursor_t &cursor) const
+        {
+        cursor.segment = 0;
+        cursor.slot = 0;
+        }
+
+    ///
+    /// \brief return the next valid record, or \c nullptr at the end.
+    ///
+    /// \details
+    ///     Records without a commit marker or with a bad CRC are
+    ///     skipped. The result points into the mapping.
+    ///
+    const ArchiveRecord_t *next(Cursor_t &cursor) const
+        {
+        while (cursor.segment < this->m_segments.size())
+            {
+            auto const &s = this->m_segments[cursor.segment];
+
+            if (cursor.slot >= s.nRecords)
+                {
+                ++cursor.segment;
+                cursor.slot = 0;
+                continue;
+                }
+
+            auto const pRecord = s.pRecords + cursor.slot++;
+            if (isValid(*pRecord))
+                return pRecord;
+            }
+
+        return nullptr;
+        }
+
+    /// \brief return \c true if a record is committed and its CRC is good.
+    static bool isValid(const ArchiveRecord_t &record)
+        {
+        return record.isCommitted() && crc8(record.bytes, 10) == record.bytes[10];
+        }
+
+    ///
+    /// \brief convert records to lux, in bulk.
+    ///
+    /// \param [in] pRecords points to the records.
+    /// \param [in] nRecords is the number of records.
+    /// \param [out] pLux receives one lux value per record.
+    ///
+    /// \details
+    ///     The result matches DataRegs_t::luxComputation(). Records that
+    ///     are not committed, or not valid according to their status
+    ///     register, convert to zero; the CRC is not checked.
+    ///
+    static void convertLux(const ArchiveRecord_t *pRecords, std::size_t nRecords, float *pLux)
+        {
+        auto const &tables = getTables();
+
+        for (std::size_t i = 0; i < nRecords; ++i)
+            {
+            auto const &r = pRecords[i].bytes;
+            float const ch1 = float(r[4] | (r[5] << 8));
+            float const ch0 = float(r[6] | (r[7] << 8));
+            float const divisor = tables.divisor[r[8] >> 4][(r[9] >> 3) & 7];
+            bool const fOk = r[SampleStore_t::kRecordSize - 1] == SampleStore_t::kCommit &&
+                             (r[8] & std::uint8_t(LTR_329ALS_PARAMS::ALS_STATUS_BITS::INVALID)) == 0;
+
+            float const sum = ch0 + ch1;
+            float const ratio = ch1 / (sum > 0.0f ? sum : 1.0f);
+
+            float const c0 = ratio < DataRegs_t::kLuxRatio1 ? DataRegs_t::kLuxCh0Coeff1
+                           : ratio < DataRegs_t::kLuxRatio2 ? DataRegs_t::kLuxCh0Coeff2
+                           : ratio < DataRegs_t::kLuxRatio3 ? DataRegs_t::kLuxCh0Coeff3
+                           :                                  0.0f;
+            float const c1 = ratio < DataRegs_t::kLuxRatio1 ? DataRegs_t::kLuxCh1Coeff1
+                           : ratio < DataRegs_t::kLuxRatio2 ? DataRegs_t::kLuxCh1Coeff2
+                           : ratio < DataRegs_t::kLuxRatio3 ? DataRegs_t::kLuxCh1Coeff3
+                           :                                  0.0f;
+
+            pLux[i] = fOk ? ((c0 * ch0 + c1 * ch1) * 100.0f) / divisor : 0.0f;
+            }
+        }
+
+    /// \brief convert a span of records to lux, in bulk.
+    static void convertLux(const Span_t &span, float *pLux)
+        {
+        convertLux(span.pRecords, span.nRecords, pLux);
+        }
+
+    /// \brief compute the CRC-8 used for records (table-driven).
+    static std::uint8_t crc8(const std::uint8_t *p, std::size_t n)
+        {
+        auto const &tables = getTables();
+        std::uint8_t crc = 0;
+
+        for (; n > 0; --n)
+            crc = tables.crc[crc ^ *p++];
+
+        return crc;
+        }
+
+protected:
+    /// \brief a segment in the mapping
+    struct Segment_t
+        {
+        std::uint32_t           sequence;   ///< sequence number
+        const ArchiveRecord_t  *pRecords;   ///< first record slot
+        std::size_t             nRecords;   ///< slots written
+        };
+
+    /// \brief lookup tables, built on first use
+    struct Tables_t
+        {
+        float           divisor[16][8];     ///< gain * iTime, by gain bits (and INVALID) and time bits
+        std::uint8_t    crc[256];           ///< CRC-8 table
+
+        Tables_t()
+            {
+            for (unsigned g = 0; g < 16; ++g)
+                for (unsigned t = 0; t < 8; ++t)
+                    this->divisor[g][t] = float(AlsGain_t::bitsToGain(g & 7) *
+                                                AlsMeasRate_t::bitsToIntegration(t));
+
+            for (unsigned i = 0; i < 256; ++i)
+                {
+                std::uint8_t const b = std::uint8_t(i);
+                this->crc[i] = bitwiseCrc8(&b, 1);
+                }
+            }
+
+        /// \brief bitwise CRC-8, to build the table.
+        static std::uint8_t bitwiseCrc8(const std::uint8_t *p, std::size_t n)
+            {
+            std::uint8_t crc = 0;
+
+            for (; n > 0; --n)
+                {
+                crc ^= *p++;
+                for (unsigned i = 0; i < 8; ++i)
+                    crc = (crc & 0x80) ? std::uint8_t((crc << 1) ^ 0x07) : std::uint8_t(crc << 1);
+                }
+            return crc;
+            }
+        };
+
+    static const Tables_t &getTables()
+        {
+        static const Tables_t tables;
+        return tables;
+        }
+
+    static std::uint32_t getUint32(const std::uint8_t *p)
+        {
+        return std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8) |
+               (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+        }
+
+    /// \brief find and order the valid segments.
+    void scan()
+        {
+        std::size_t const nSegments = this->m_nBase / this->m_segmentSize;
+        std::size_t const nSlots = (this->m_segmentSize - SampleStore_t::kHeaderSize) / SampleStore_t::kRecordSize;
+
+        for (std::size_t i = 0; i < nSegments; ++i)
+            {
+            auto const pSegment = this->m_pBase + i * this->m_segmentSize;
+
+            if (getUint32(pSegment) != SampleStore_t::kMagic ||
+                pSegment[SampleStore_t::kHeaderSize - 1] != SampleStore_t::kCommit)
+                continue;
+
+            auto const pRecords = reinterpret_cast<const ArchiveRecord_t *>(pSegment + SampleStore_t::kHeaderSize);
+
+            // erased slots form a suffix; find the first by binary search.
+            std::size_t lo = 0;
+            std::size_t hi = nSlots;
+            while (lo < hi)
+                {
+                std::size_t const mid = lo + (hi - lo) / 2;
+                auto const &b = pRecords[mid].bytes;
+
+                if (std::all_of(b, b + SampleStore_t::kRecordSize, [](std::uint8_t v) { return v == 0xFF; }))
+                    hi = mid;
+                else
+                    lo = mid + 1;
+                }
+
+            this->m_segments.push_back(Segment_t { getUint32(pSegment + 4), pRecords, lo });
+            }
+
+        std::sort(
+            this->m_segments.begin(), this->m_segments.end(),
+            [](const Segment_t &a, const Segment_t &b) { return a.sequence < b.sequence; }
+            );
+        }
+
+private:
+    const std::uint8_t     *m_pBase = nullptr;  ///< base of the mapping
+    std::size_t             m_nBase = 0;        ///< size of the mapping
+    std::uint32_t           m_segmentSize = 0;  ///< segment size
+    std::vector<Segment_t>  m_segments;         ///< valid segments, oldest first
+    };
+
+} // end namespace Mcci_Ltr_329als
+
+#endif /* _mcci_ltr_329als_archive_h_ */
@@ -0,0 +1,245 @@
+/*
+
+Module: mcci_ltr_329als_backlight.cpp
+
+Function:
+    Implementation code for the backlight controller.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "mcci_ltr_329als_backlight.h"
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Read-only data.
+|
+\****************************************************************************/
+
+// log2(1 + i/16) in Q16, for i in [0, 16].
+static const std::uint32_t kLog2Table[17] =
+    {
+    0, 5732, 11136, 16248, 21098, 25711, 30109, 34312,
+    38336, 42196, 45904, 49472, 52911, 56229, 59434, 62534,
+    65536,
+    };
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+BacklightController_t::logq_t BacklightController_t::log2Q16(std::uint32_t x)
+    {
+    if (x <= 1)
+        return 0;
+
+    // integer part: position of the most significant bit.
+    unsigned n = 0;
+    for (unsigned shift = 16; shift > 0; shift >>= 1)
+        {
+        if (x >> (n + shift))
+            n += shift;
+        }
+
+    // normalize the mantissa to 1.31, and drop the leading one.
+    std::uint32_t const frac = (x << (31 - n)) << 1;
+
+    // interpolate in the table with the top 4 bits and the next 16.
+    unsigned const i = frac >> 28;
+    std::uint32_t const t = (frac >> 12) & 0xFFFF;
+    std::uint32_t const lo = kLog2Table[i];
+    std::uint32_t const hi = kLog2Table[i + 1];
+
+    return logq_t((n << 16) + lo + (((hi - lo) * t) >> 16));
+    }
+
+bool BacklightController_t::setLuxRange(std::uint32_t darkMilliLux, std::uint32_t brightMilliLux)
+    {
+    if (! (brightMilliLux > darkMilliLux))
+        return false;
+
+    logq_t const logDark = log2Q16(darkMilliLux);
+    logq_t const logBright = log2Q16(brightMilliLux);
+
+    if (! (logBright > logDark))
+        return false;
+
+    this->m_logDark = logDark;
+    this->m_logBright = logBright;
+    return true;
+    }
+
+bool BacklightController_t::setOutputRange(std::uint16_t pwmMin, std::uint16_t pwmMax)
+    {
+    if (pwmMax < pwmMin)
+        return false;
+
+    this->m_pwmMin = pwmMin;
+    this->m_pwmMax = pwmMax;
+    this->m_pwm = this->levelToPwm();
+    return true;
+    }
+
+bool BacklightController_t::setIntervals(std::uint32_t fastMs, std::uint32_t slowMs, logq_t stableBand)
+    {
+    if (fastMs == 0 || slowMs < fastMs || stableBand < 0)
+        return false;
+
+    this->m_fastMs = fastMs;
+    this->m_slowMs = slowMs;
+    this->m_stableBand = stableBand;
+    return true;
+    }
+
+/*
+
+Name:	BacklightController_t::update()
+
+Function:
+    Add a sample, and compute the new output.
+
+Definition:
+    std::uint16_t BacklightController_t::update(
+        std::uint32_t nowMs,
+        std::uint32_t milliLux
+        );
+
+Description:
+    The sample is converted to log2 in Q16, and the smoothed log
+    level moves towards it by dt / (tau + dt) of the difference,
+    which is a first-order low-pass filter with time constant tau
+    for any sample spacing. The smoothed level is mapped onto the
+    perceptual range, and the output level moves towards that
+    target by at most 65535 * dt / fullScale. The first sample
+    after reset() sets everything directly.
+
+    The controller is settling if the sample is outside the stable
+    band around the smoothed level, or the output didn't reach its
+    target.
+
+Returns:
+    The new PWM value.
+
+*/
+
+#define FUNCTION "BacklightController_t::update"
+
+std::uint16_t
+BacklightController_t::update(
+    std::uint32_t nowMs,
+    std::uint32_t milliLux
+    )
+    {
+    logq_t const x = log2Q16(milliLux);
+    std::uint32_t const dt = nowMs - this->m_lastTime;
+
+    this->m_lastTime = nowMs;
+
+    if (! this->m_fValid)
+        {
+        this->m_logSmooth = x;
+        }
+    else if (this->m_timeConstantMs == 0)
+        {
+        this->m_logSmooth = x;
+        }
+    else
+        {
+        // alpha = dt / (tau + dt), in Q16.
+        std::uint32_t const dtc = dt < this->m_timeConstantMs * 8 ? dt : this->m_timeConstantMs * 8;
+        std::int64_t const alpha = (std::int64_t(dtc) << 16) / (this->m_timeConstantMs + dtc);
+
+        this->m_logSmooth += logq_t(((std::int64_t(x) - this->m_logSmooth) * alpha) >> 16);
+        }
+
+    // map onto the perceptual range.
+    std::uint32_t target;
+    if (this->m_logSmooth <= this->m_logDark)
+        target = 0;
+    else if (this->m_logSmooth >= this->m_logBright)
+        target = 0xFFFF;
+    else
+        target = std::uint32_t(
+                    (std::int64_t(this->m_logSmooth - this->m_logDark) * 0xFFFF) /
+                    (this->m_logBright - this->m_logDark)
+                    );
+
+    // move the output towards the target, within the slew limit.
+    if (! this->m_fValid || this->m_fullScaleMs == 0)
+        {
+        this->m_level = target;
+        }
+    else
+        {
+        std::uint64_t step64 = (std::uint64_t(0xFFFF) * dt) / this->m_fullScaleMs;
+        std::uint32_t const step = step64 > 0xFFFF ? 0xFFFF : (step64 == 0 ? 1 : std::uint32_t(step64));
+
+        if (target > this->m_level)
+            this->m_level = (target - this->m_level > step) ? this->m_level + step : target;
+        else
+            this->m_level = (this->m_level - target > step) ? this->m_level - step : target;
+        }
+
+    logq_t const error = x - this->m_logSmooth;
+    this->m_fSettling = this->m_level != target ||
+                        error > this->m_stableBand || -error > this->m_stableBand;
+
+    this->m_fValid = true;
+    this->m_pwm = this->levelToPwm();
+    return this->m_pwm;
+    }
+
+#undef FUNCTION
+
+std::uint16_t BacklightController_t::levelToPwm() const
+    {
+    // square law: duty = level^2, in Q32.
+    std::uint64_t const level2 = std::uint64_t(this->m_level) * this->m_level;
+    std::uint32_t const span = this->m_pwmMax - this->m_pwmMin;
+
+    return std::uint16_t(this->m_pwmMin + ((level2 * span + 0x7FFE0001u) / 0xFFFE0001u));
+    }
+
+bool BacklightController_t::poll(Ltr_329als &ltr, std::uint32_t nowMs, bool &fError)
+    {
+    fError = false;
+
+    if (ltr.getState() == Ltr_329als::State::Idle)
+        {
+        if (this->m_fStarted && nowMs - this->m_startTime < this->getRecommendedIntervalMs())
+            return false;
+
+        if (! ltr.startMeasurement(true))
+            {
+            fError = true;
+            return false;
+            }
+
+        this->m_startTime = nowMs;
+        this->m_fStarted = true;
+        return false;
+        }
+
+    if (! ltr.queryReady(fError))
+        return false;
+
+    // skip samples the sensor marked invalid.
+    bool fInvalid;
+    float const lux = ltr.getRawData().computeLux(fInvalid);
+    if (fInvalid)
+        return false;
+
+    this->updateLux(nowMs, lux);
+    return true;
+    }
+
+/**** end of mcci_ltr_329als_backlight.cpp ****/
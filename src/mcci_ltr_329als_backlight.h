@@ -0,0 +1,251 @@
+/*
+
+Module: mcci_ltr_329als_backlight.h
+
+Function:
+    Backlight controller for the MCCI LTR-329ALS library.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+/// \file
+
+#ifndef _mcci_ltr_329als_backlight_h_
+#define _mcci_ltr_329als_backlight_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <cstdint>
+#include "mcci_ltr_329als.h"
+
+namespace Mcci_Ltr_329als {
+
+///
+/// \brief Map ambient light to a display backlight PWM value.
+///
+/// \details
+///     The eye's response to light is roughly logarithmic, so the
+///     controller works in the log domain: each sample is converted
+///     to log2(millilux) in fixed point, smoothed with a first-order
+///     filter, and mapped linearly from the dark..bright lux range
+///     onto a perceptual level from 0 to 65535. The level moves
+///     towards its target no faster than the slew limit, and is
+///     converted to PWM with a square law (an approximation of the
+///     display's gamma), between the minimum and maximum PWM values.
+///     Everything after the input is integer arithmetic.
+///
+///     The controller also decides how often it needs samples: the
+///     fast interval (default 50 ms, 20 Hz) while the light is changing
+///     or the output is still slewing, and the slow interval (default
+///     2 s, 0.5 Hz) once it has settled. poll() runs the sensor on that
+///     schedule with single measurements, so the application need only
+///     call poll() and write getPwm() to the PWM output:
+///
+///     \code
+///     BacklightController_t backlight;
+///     bool fError;
+///     if (backlight.poll(gLtr, millis(), fError))
+///         analogWrite(kBacklightPin, backlight.getPwm());
+///     \endcode
+///
+///     To sample at 20 Hz, configure the sensor for an integration time
+///     of 50 ms; a single measurement takes one integration time.
+///
+class BacklightController_t
+    {
+public:
+    /// \brief log2 in Q16 fixed point (16 fraction bits).
+    using logq_t = std::int32_t;
+
+    /// \brief default light level for the minimum output, in millilux.
+    static constexpr std::uint32_t kDefaultDarkMilliLux = 1000;
+    /// \brief default light level for the maximum output, in millilux.
+    static constexpr std::uint32_t kDefaultBrightMilliLux = 10000 * 1000;
+    /// \brief default minimum PWM value.
+    static constexpr std::uint16_t kDefaultPwmMin = 8;
+    /// \brief default maximum PWM value.
+    static constexpr std::uint16_t kDefaultPwmMax = 255;
+    /// \brief default smoothing time constant, in ms.
+    static constexpr std::uint32_t kDefaultTimeConstantMs = 400;
+    /// \brief default time for the output to slew across its full range, in ms.
+    static constexpr std::uint32_t kDefaultFullScaleMs = 2000;
+    /// \brief default sampling interval while changing, in ms.
+    static constexpr std::uint32_t kDefaultFastIntervalMs = 50;
+    /// \brief default sampling interval when settled, in ms.
+    static constexpr std::uint32_t kDefaultSlowIntervalMs = 2000;
+    /// \brief default settling band, in Q16 log2 units (1/8 octave, about 9%).
+    static constexpr logq_t kDefaultStableBand = 65536 / 8;
+
+    BacklightController_t() = default;
+
+    ///
+    /// \brief set the light levels for minimum and maximum output.
+    ///
+    /// \param [in] darkMilliLux is the level at or below which the
+    ///     output is at its minimum.
+    /// \param [in] brightMilliLux is the level at or above which the
+    ///     output is at its maximum; it must be greater than
+    ///     \p darkMilliLux.
+    ///
+    /// \return \c true for success, \c false for invalid parameters.
+    ///
+    bool setLuxRange(std::uint32_t darkMilliLux, std::uint32_t brightMilliLux);
+
+    ///
+    /// \brief set the PWM output range.
+    ///
+    /// \param [in] pwmMin is the output at the minimum level.
+    /// \param [in] pwmMax is the output at the maximum level; it must
+    ///     not be less than \p pwmMin.
+    ///
+    /// \return \c true for success, \c false for invalid parameters.
+    ///
+    bool setOutputRange(std::uint16_t pwmMin, std::uint16_t pwmMax);
+
+    ///
+    /// \brief set the dynamic response.
+    ///
+    /// \param [in] timeConstantMs is the time constant of the smoothing
+    ///     filter; zero disables smoothing.
+    /// \param [in] fullScaleMs is the shortest time in which the output
+    ///     may move from minimum to maximum; zero disables the limit.
+    ///
+    void setResponse(std::uint32_t timeConstantMs, std::uint32_t fullScaleMs)
+        {
+        this->m_timeConstantMs = timeConstantMs;
+        this->m_fullScaleMs = fullScaleMs;
+        }
+
+    ///
+    /// \brief set the sampling intervals.
+    ///
+    /// \param [in] fastMs is the interval while the light is changing.
+    /// \param [in] slowMs is the interval when settled; it must not be
+    ///     less than \p fastMs.
+    /// \param [in] stableBand is how far (in Q16 log2 units) a sample
+    ///     may be from the smoothed level and still count as settled.
+    ///
+    /// \return \c true for success, \c false for invalid parameters.
+    ///
+    bool setIntervals(std::uint32_t fastMs, std::uint32_t slowMs, logq_t stableBand = kDefaultStableBand);
+
+    /// \brief forget the history; the next sample sets the output directly.
+    void reset()
+        {
+        this->m_fValid = false;
+        this->m_fSettling = true;
+        }
+
+    ///
+    /// \brief add a sample.
+    ///
+    /// \param [in] nowMs is the time of the sample, e.g. from millis().
+    /// \param [in] milliLux is the light level, in millilux.
+    ///
+    /// \return the new PWM value.
+    ///
+    std::uint16_t update(std::uint32_t nowMs, std::uint32_t milliLux);
+
+    /// \brief add a sample in lux, as returned by Ltr_329als::getLux().
+    std::uint16_t updateLux(std::uint32_t nowMs, float lux)
+        {
+        std::uint32_t milliLux;
+
+        if (! (lux > 0.0f))
+            milliLux = 0;
+        else if (lux >= 4294967.0f)
+            milliLux = UINT32_MAX;
+        else
+            milliLux = std::uint32_t(lux * 1000.0f + 0.5f);
+
+        return this->update(nowMs, milliLux);
+        }
+
+    ///
+    /// \brief run the sensor and the controller.
+    ///
+    /// \param [in] ltr is the sensor driver. It must have been started
+    ///     with begin(); this function uses single measurements.
+    /// \param [in] nowMs is the current time.
+    /// \param [out] fError is set \c true if the driver reported a hard
+    ///     error (its last error is set).
+    ///
+    /// \return \c true if a new sample was processed, so getPwm() may
+    ///     have changed.
+    ///
+    /// \details
+    ///     Call this often, e.g. from loop(). When the driver is idle
+    ///     and the recommended interval has passed since the last
+    ///     measurement started, a single measurement is started; when
+    ///     it completes, the sample is passed to updateLux().
+    ///
+    bool poll(Ltr_329als &ltr, std::uint32_t nowMs, bool &fError);
+
+    /// \brief return the current PWM value.
+    std::uint16_t getPwm() const
+        {
+        return this->m_pwm;
+        }
+
+    /// \brief return the current perceptual level, 0 to 65535.
+    std::uint16_t getLevel() const
+        {
+        return std::uint16_t(this->m_level);
+        }
+
+    /// \brief return \c true while the light is changing or the output is slewing.
+    bool isSettling() const
+        {
+        return this->m_fSettling;
+        }
+
+    ///
+    /// \brief return the recommended time between samples.
+    ///
+    /// \return the fast interval while settling, the slow interval otherwise.
+    ///
+    std::uint32_t getRecommendedIntervalMs() const
+        {
+        return this->m_fSettling ? this->m_fastMs : this->m_slowMs;
+        }
+
+    ///
+    /// \brief compute log2 of an integer.
+    ///
+    /// \param [in] x is the value; zero is treated as one.
+    ///
+    /// \return log2(x) in Q16, accurate to about 0.0005.
+    ///
+    static logq_t log2Q16(std::uint32_t x);
+
+private:
+    /// \brief compute the PWM value for the current level.
+    std::uint16_t levelToPwm() const;
+
+    logq_t          m_logDark = log2Q16(kDefaultDarkMilliLux);          ///< log2 of dark level
+    logq_t          m_logBright = log2Q16(kDefaultBrightMilliLux);      ///< log2 of bright level
+    logq_t          m_logSmooth = 0;                                    ///< smoothed log2 of input
+    logq_t          m_stableBand = kDefaultStableBand;                  ///< settled if within this
+    std::uint32_t   m_timeConstantMs = kDefaultTimeConstantMs;          ///< smoothing time constant
+    std::uint32_t   m_fullScaleMs = kDefaultFullScaleMs;                ///< slew limit, ms for full range
+    std::uint32_t   m_fastMs = kDefaultFastIntervalMs;                  ///< interval while settling
+    std::uint32_t   m_slowMs = kDefaultSlowIntervalMs;                  ///< interval when settled
+    std::uint32_t   m_lastTime = 0;                                     ///< time of the last sample
+    std::uint32_t   m_startTime = 0;                                    ///< time of the last measurement started by poll()
+    std::uint32_t   m_level = 0;                                        ///< perceptual level, 0..65535
+    std::uint16_t   m_pwmMin = kDefaultPwmMin;                          ///< output at level 0
+    std::uint16_t   m_pwmMax = kDefaultPwmMax;                          ///< output at level 65535
+    std::uint16_t   m_pwm = kDefaultPwmMax;                             ///< current output
+    bool            m_fValid = false;                                   ///< true once a sample has been seen
+    bool            m_fSettling = true;                                 ///< true while changing
+    bool            m_fStarted = false;                                 ///< true if poll() started a measurement
+    };
+
+} // end namespace Mcci_Ltr_329als
+
+#endif /* _mcci_ltr_329als_backlight_h_ */
@@ -0,0 +1,109 @@
+/*
+
+Module: mcci_ltr_329als_daylight.cpp
+
+Function:
+    Implementation code for the daylight profile.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "mcci_ltr_329als_daylight.h"
+#include <math.h>
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+void DaylightProfile_t::reset()
+    {
+    for (auto &bin : this->m_bins)
+        bin = Bin_t { 0.0f, 0.0f, 0.0f, 0 };
+    }
+
+void DaylightProfile_t::update(std::uint32_t secondsOfDay, float lux)
+    {
+    auto &bin = this->m_bins[getBinIndex(secondsOfDay)];
+
+    if (bin.count == 0)
+        {
+        bin.mean = bin.min = bin.max = lux;
+        bin.count = 1;
+        return;
+        }
+
+    if (lux < bin.min)
+        bin.min = lux;
+    if (lux > bin.max)
+        bin.max = lux;
+
+    // once the count saturates, the mean becomes a slow moving average.
+    if (bin.count < 0xFFFF)
+        ++bin.count;
+
+    bin.mean += (lux - bin.mean) / bin.count;
+    }
+
+std::uint16_t DaylightProfile_t::encodeLux(float lux)
+    {
+    if (! (lux > 0.0f))
+        return 0;
+
+    float const code = 2048.0f * log2f(1.0f + lux) + 0.5f;
+    return (code >= 65535.0f) ? 0xFFFF : std::uint16_t(code);
+    }
+
+float DaylightProfile_t::decodeLux(std::uint16_t code)
+    {
+    return exp2f(code / 2048.0f) - 1.0f;
+    }
+
+static std::uint8_t *putUint16(std::uint8_t *p, std::uint16_t v)
+    {
+    *p++ = std::uint8_t(v >> 8);
+    *p++ = std::uint8_t(v);
+    return p;
+    }
+
+std::size_t DaylightProfile_t::serialize(
+    std::uint8_t *pBuffer,
+    std::size_t nBuffer,
+    unsigned firstBin,
+    unsigned nBins
+    ) const
+    {
+    if (pBuffer == nullptr || firstBin >= kBins || nBins > kBins - firstBin)
+        return 0;
+
+    std::size_t const nResult = getSerializedSize(nBins);
+    if (nBuffer < nResult)
+        return 0;
+
+    auto p = pBuffer;
+    *p++ = kFormat;
+    *p++ = std::uint8_t(firstBin);
+    *p++ = std::uint8_t(nBins);
+
+    for (unsigned i = firstBin; i < firstBin + nBins; ++i)
+        {
+        auto const &bin = this->m_bins[i];
+
+        p = putUint16(p, bin.count);
+        p = putUint16(p, encodeLux(bin.mean));
+        p = putUint16(p, encodeLux(bin.min));
+        p = putUint16(p, encodeLux(bin.max));
+        }
+
+    return nResult;
+    }
+
+/**** end of mcci_ltr_329als_daylight.cpp ****/
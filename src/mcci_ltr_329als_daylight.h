@@ -0,0 +1,142 @@
+/*
+
+Module: mcci_ltr_329als_daylight.h
+
+Function:
+    24-hour daylight profile for the MCCI LTR-329ALS library.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+/// \file
+
+#ifndef _mcci_ltr_329als_daylight_h_
+#define _mcci_ltr_329als_daylight_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Mcci_Ltr_329als {
+
+///
+/// \brief Accumulate a daylight curve in fixed memory.
+///
+/// \details
+///     The day is divided into kBins bins of kBinSeconds each. Each
+///     bin holds the mean, minimum and maximum lux and the number of
+///     samples. Samples are added with update(), which takes constant
+///     time; the profile keeps accumulating across days until reset()
+///     is called, so each bin describes that time of day over the
+///     whole collection period.
+///
+///     serialize() produces a compact big-endian encoding for uplink;
+///     lux values are encoded on a logarithmic scale with encodeLux().
+///
+class DaylightProfile_t
+    {
+public:
+    /// \brief the number of bins per day.
+    static constexpr unsigned kBins = 96;
+
+    /// \brief the width of each bin, in seconds.
+    static constexpr std::uint32_t kBinSeconds = 86400 / kBins;
+
+    /// \brief the format byte that starts the serialized form.
+    static constexpr std::uint8_t kFormat = 0x01;
+
+    /// \brief size of the serialized header (format, first bin, bin count).
+    static constexpr std::size_t kHeaderSize = 3;
+
+    /// \brief size of each serialized bin (count, mean, min, max).
+    static constexpr std::size_t kBinSize = 8;
+
+    /// \brief statistics for one bin
+    struct Bin_t
+        {
+        float           mean;       ///< mean lux
+        float           min;        ///< minimum lux
+        float           max;        ///< maximum lux
+        std::uint16_t   count;      ///< number of samples (saturates at 65535)
+        };
+
+    DaylightProfile_t()
+        {
+        this->reset();
+        }
+
+    /// \brief clear all bins.
+    void reset();
+
+    ///
+    /// \brief add a sample to the profile.
+    ///
+    /// \param [in] secondsOfDay is the local time of the sample, in
+    ///     seconds since midnight; values of a day or more are reduced
+    ///     modulo one day.
+    /// \param [in] lux is the light level.
+    ///
+    void update(std::uint32_t secondsOfDay, float lux);
+
+    /// \brief return the bin index for a time of day.
+    static constexpr unsigned getBinIndex(std::uint32_t secondsOfDay)
+        {
+        return unsigned((secondsOfDay % 86400u) / kBinSeconds);
+        }
+
+    /// \brief return a bin; \p i must be less than kBins.
+    const Bin_t &getBin(unsigned i) const
+        {
+        return this->m_bins[i];
+        }
+
+    /// \brief return the buffer size needed to serialize \p nBins bins.
+    static constexpr std::size_t getSerializedSize(unsigned nBins = kBins)
+        {
+        return kHeaderSize + nBins * kBinSize;
+        }
+
+    ///
+    /// \brief serialize some or all of the bins.
+    ///
+    /// \param [out] pBuffer receives the encoded bins.
+    /// \param [in] nBuffer is the size of the buffer.
+    /// \param [in] firstBin is the first bin to encode.
+    /// \param [in] nBins is the number of bins to encode.
+    ///
+    /// \return
+    ///     the number of bytes used, or zero if the buffer is too small
+    ///     or the bin range is invalid.
+    ///
+    /// \details
+    ///     The format is: format byte, first bin, bin count; then for
+    ///     each bin, the sample count, mean, minimum and maximum, each
+    ///     as a big-endian \c uint16_t. Lux values are encoded with
+    ///     encodeLux(). Serializing in pieces allows the profile to be
+    ///     sent in several small messages.
+    ///
+    std::size_t serialize(std::uint8_t *pBuffer, std::size_t nBuffer, unsigned firstBin = 0, unsigned nBins = kBins) const;
+
+    ///
+    /// \brief encode a lux value on a logarithmic scale.
+    ///
+    /// \return \c round(2048 * log2(1 + lux)), limited to [0, 65535].
+    ///
+    static std::uint16_t encodeLux(float lux);
+
+    /// \brief decode a value produced by encodeLux().
+    static float decodeLux(std::uint16_t code);
+
+private:
+    Bin_t   m_bins[kBins];          ///< the bins
+    };
+
+} // end namespace Mcci_Ltr_329als
+
+#endif /* _mcci_ltr_329als_daylight_h_ */
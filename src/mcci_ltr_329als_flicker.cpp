@@ -0,0 +1,147 @@
+/*
+
+Module: mcci_ltr_329als_flicker.cpp
+
+Function:
+    Implementation code for LTR-329ALS flicker estimation.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "mcci_ltr_329als_flicker.h"
+#include <math.h>
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+void FlickerEstimator_t::begin(std::uint16_t nSamples)
+    {
+    *this = FlickerEstimator_t();
+    this->m_nSamples = nSamples;
+    }
+
+bool FlickerEstimator_t::update(const DataRegs_t &sample)
+    {
+    bool fError;
+
+    if (this->isComplete())
+        return true;
+
+    // use computeLux() to check that the sample is new and valid.
+    (void) sample.computeLux(fError);
+    if (fError)
+        return false;
+
+    std::uint32_t const v = sample.getTotalCounts();
+    float const x = float(v);
+
+    if (this->m_count == 0)
+        {
+        this->m_min = this->m_max = v;
+        }
+    else
+        {
+        if (v < this->m_min)
+            this->m_min = v;
+        if (v > this->m_max)
+            this->m_max = v;
+        }
+
+    // Welford's update of mean and variance.
+    ++this->m_count;
+    float const delta = x - this->m_mean;
+    this->m_mean += delta / this->m_count;
+    this->m_m2 += delta * (x - this->m_mean);
+
+    // count crossings of the (running) mean.
+    std::int8_t const sign = (x > this->m_mean) ? 1 : (x < this->m_mean) ? -1 : 0;
+    if (sign != 0)
+        {
+        if (this->m_lastSign != 0 && sign != this->m_lastSign)
+            ++this->m_crossings;
+        this->m_lastSign = sign;
+        }
+
+    return this->isComplete();
+    }
+
+float FlickerEstimator_t::getStdDev() const
+    {
+    if (this->m_count < 2)
+        return 0.0f;
+
+    return sqrtf(this->m_m2 / (this->m_count - 1));
+    }
+
+static std::uint16_t toPermille(float value, float mean)
+    {
+    if (! (mean > 0.0f))
+        return 0;
+
+    float const result = value * 1000.0f / mean;
+    return (result >= 65535.0f) ? 65535 : std::uint16_t(result + 0.5f);
+    }
+
+std::uint16_t FlickerEstimator_t::getAmplitudePermille() const
+    {
+    return toPermille(this->getStdDev(), this->m_mean);
+    }
+
+std::uint16_t FlickerEstimator_t::getPeakToPeakPermille() const
+    {
+    if (this->m_count == 0)
+        return 0;
+
+    return toPermille(float(this->m_max - this->m_min), this->m_mean);
+    }
+
+float FlickerEstimator_t::getAliasFrequency() const
+    {
+    if (this->m_count < 2)
+        return 0.0f;
+
+    // two crossings per cycle of the beat.
+    float const duration = (this->m_count - 1) * (kBurstRate / 1000.0f);
+    return this->m_crossings / (2.0f * duration);
+    }
+
+AlsMeasRate_t::Integration_t
+FlickerEstimator_t::recommendIntegration(
+    std::uint8_t mainsHz,
+    AlsMeasRate_t::Rate_t maxTime,
+    std::uint16_t targetPermille
+    ) const
+    {
+    std::uint32_t const amplitude = this->getAmplitudePermille();
+    AlsMeasRate_t::Integration_t best = 0;
+
+    // every integration time is a multiple of 50 ms, which is five
+    // periods of 100 Hz flicker and six of 120 Hz; so for 50 or 60 Hz
+    // mains, any of them will do.
+    if (mainsHz != 50 && mainsHz != 60)
+        return 0;
+
+    for (auto const iTime : AlsMeasRate_t::vTimes)
+        {
+        if (iTime > maxTime)
+            break;
+
+        best = iTime;
+        if (amplitude * kBurstIntegration <= std::uint32_t(targetPermille) * iTime)
+            break;
+        }
+
+    return best;
+    }
+
+/**** end of mcci_ltr_329als_flicker.cpp ****/
@@ -0,0 +1,160 @@
+/*
+
+Module: mcci_ltr_329als_flicker.h
+
+Function:
+    Mains flicker estimation for the MCCI LTR-329ALS library.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+/// \file
+
+#ifndef _mcci_ltr_329als_flicker_h_
+#define _mcci_ltr_329als_flicker_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <cstdint>
+#include "mcci_ltr_329als_regs.h"
+
+namespace Mcci_Ltr_329als {
+
+using namespace Mcci_Ltr_329als_Regs;
+
+///
+/// \brief Estimate light flicker from a burst of short integrations.
+///
+/// \details
+///     Feed the estimator the samples from a burst of continuous
+///     measurements taken with kBurstIntegration and kBurstRate.
+///     It keeps running statistics only (mean, variance, extremes
+///     and mean-crossings), so it uses constant memory regardless
+///     of the length of the burst.
+///
+///     Flicker that is not averaged out by the integration window
+///     shows up as spread in the samples. Because the samples are
+///     taken far below the flicker frequency, the flicker aliases
+///     down to a slow beat; its frequency is estimated from the
+///     rate at which the samples cross their mean.
+///
+///     A typical flow:
+///
+///     \code
+///     gLtr.configure(gain, FlickerEstimator_t::kBurstRate, FlickerEstimator_t::kBurstIntegration);
+///     gFlicker.begin(64);
+///     gLtr.startMeasurement(false);
+///     // ... on each queryReady(): if (gFlicker.update(gLtr.getRawData())) done.
+///     auto iTime = gFlicker.recommendIntegration(60, 1000, 10);
+///     \endcode
+///
+class FlickerEstimator_t
+    {
+public:
+    /// \brief integration time to use for the diagnostic burst, in ms.
+    static constexpr AlsMeasRate_t::Integration_t kBurstIntegration = 50;
+
+    /// \brief measurement rate to use for the diagnostic burst, in ms.
+    static constexpr AlsMeasRate_t::Rate_t kBurstRate = 50;
+
+    /// \brief start a new burst of \p nSamples samples.
+    void begin(std::uint16_t nSamples);
+
+    ///
+    /// \brief add a sample to the burst
+    ///
+    /// \param [in] sample is the data from the sensor; it's ignored if
+    ///     it's not new and valid.
+    ///
+    /// \return \c true if the burst is complete.
+    ///
+    bool update(const DataRegs_t &sample);
+
+    /// \brief return \c true if the requested number of samples has been seen.
+    bool isComplete() const
+        {
+        return this->m_count >= this->m_nSamples;
+        }
+
+    /// \brief return the number of samples processed so far.
+    std::uint16_t getCount() const
+        {
+        return this->m_count;
+        }
+
+    /// \brief return the mean of the total counts.
+    float getMean() const
+        {
+        return this->m_mean;
+        }
+
+    /// \brief return the standard deviation of the total counts.
+    float getStdDev() const;
+
+    ///
+    /// \brief return the flicker amplitude, in parts per thousand.
+    ///
+    /// \details
+    ///     This is the coefficient of variation of the samples, scaled
+    ///     by 1000 and limited to 65535.
+    ///
+    std::uint16_t getAmplitudePermille() const;
+
+    /// \brief return the peak-to-peak spread, in parts per thousand of the mean.
+    std::uint16_t getPeakToPeakPermille() const;
+
+    ///
+    /// \brief return the estimated alias frequency of the flicker, in Hz.
+    ///
+    /// \details
+    ///     Zero means that the spread didn't oscillate (or that there
+    ///     were too few samples to tell).
+    ///
+    float getAliasFrequency() const;
+
+    ///
+    /// \brief recommend an integration time for the measured flicker.
+    ///
+    /// \param [in] mainsHz is the mains frequency (50 or 60); the flicker
+    ///     period is taken to be half the mains period.
+    /// \param [in] maxTime is the longest acceptable integration time,
+    ///     normally the measurement rate.
+    /// \param [in] targetPermille is the acceptable residual flicker.
+    ///
+    /// \return
+    ///     The shortest integration time that is a whole number of flicker
+    ///     periods and is expected to reduce the flicker to \p targetPermille,
+    ///     or the longest such time not exceeding \p maxTime if none is
+    ///     good enough. Zero if \p mainsHz is not 50 or 60, or if there
+    ///     is no suitable integration time.
+    ///
+    /// \details
+    ///     The residual flicker after integrating over a whole number of
+    ///     periods is assumed to fall in inverse proportion to the
+    ///     integration time.
+    ///
+    AlsMeasRate_t::Integration_t recommendIntegration(
+        std::uint8_t mainsHz,
+        AlsMeasRate_t::Rate_t maxTime,
+        std::uint16_t targetPermille
+        ) const;
+
+private:
+    float           m_mean = 0.0f;      ///< running mean of total counts
+    float           m_m2 = 0.0f;        ///< running sum of squared deviations
+    std::uint32_t   m_min = 0;          ///< smallest total count seen
+    std::uint32_t   m_max = 0;          ///< largest total count seen
+    std::uint16_t   m_count = 0;        ///< number of samples seen
+    std::uint16_t   m_nSamples = 0;     ///< number of samples in the burst
+    std::uint16_t   m_crossings = 0;    ///< number of mean-crossings seen
+    std::int8_t     m_lastSign = 0;     ///< sign of the last deviation from the mean
+    };
+
+} // end namespace Mcci_Ltr_329als
+
+#endif /* _mcci_ltr_329als_flicker_h_ */
@@ -0,0 +1,277 @@
+/*
+
+Module: mcci_ltr_329als_fusion.h
+
+Function:
+    Multi-sensor fusion for the MCCI LTR-329ALS library.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+/// \file
+
+#ifndef _mcci_ltr_329als_fusion_h_
+#define _mcci_ltr_329als_fusion_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <cstdint>
+
+namespace Mcci_Ltr_329als {
+
+///
+/// \brief Combine samples from several sensors into one robust estimate.
+///
+/// \tparam a_nSensors is the number of sensors, in [1, 32].
+///
+/// \details
+///     Each sensor's lux is multiplied by its calibration factor, then
+///     the samples taken within a time window are combined with a
+///     weighted median or a weighted trimmed mean, so that one sensor
+///     that disagrees (shaded by a bird, or in direct sun) does not
+///     move the result. Sensors that differ from the estimate by more
+///     than the outlier tolerance are flagged in the result.
+///
+///     Everything is in fixed-size arrays; no memory is allocated, and
+///     fuse() runs in O(n^2) time for n sensors (an insertion sort),
+///     which is cheapest for the handful of sensors of a real
+///     installation.
+///
+template <unsigned a_nSensors>
+class SensorFusion_t
+    {
+    static_assert(a_nSensors >= 1 && a_nSensors <= 32, "a_nSensors must be in [1, 32]");
+
+public:
+    /// \brief the number of sensors.
+    static constexpr unsigned kSensors = a_nSensors;
+
+    /// \brief how samples are combined
+    enum class Method : std::uint8_t
+        {
+        Median,         ///< weighted median
+        TrimmedMean,    ///< weighted mean after dropping the extremes
+        };
+
+    /// \brief the result of fuse()
+    struct Result_t
+        {
+        float           lux;            ///< fused estimate
+        std::uint32_t   usedMask;       ///< bit i set if sensor i had a current sample
+        std::uint32_t   outlierMask;    ///< bit i set if sensor i disagreed with the estimate
+        std::uint8_t    nUsed;          ///< number of samples combined
+        };
+
+    SensorFusion_t()
+        {
+        for (unsigned i = 0; i < kSensors; ++i)
+            {
+            this->m_sensor[i].calibration = 1.0f;
+            this->m_sensor[i].weight = 1.0f;
+            this->m_sensor[i].fValid = false;
+            }
+        }
+
+    ///
+    /// \brief set the calibration of a sensor.
+    ///
+    /// \param [in] i is the sensor index.
+    /// \param [in] factor multiplies the sensor's lux (e.g. to correct
+    ///     for its window or mounting).
+    /// \param [in] weight is the sensor's relative weight in the
+    ///     combination; zero excludes it.
+    ///
+    /// \return \c true for success, \c false for invalid parameters.
+    ///
+    bool setCalibration(unsigned i, float factor, float weight = 1.0f)
+        {
+        if (i >= kSensors || ! (factor > 0.0f) || ! (weight >= 0.0f))
+            return false;
+
+        this->m_sensor[i].calibration = factor;
+        this->m_sensor[i].weight = weight;
+        return true;
+        }
+
+    ///
+    /// \brief choose the combining method.
+    ///
+    /// \param [in] method is the method.
+    /// \param [in] nTrim is the number of samples dropped from each end
+    ///     for Method::TrimmedMean (fewer if not enough samples).
+    ///
+    void setMethod(Method method, std::uint8_t nTrim = 1)
+        {
+        this->m_method = method;
+        this->m_nTrim = nTrim;
+        }
+
+    ///
+    /// \brief set the outlier tolerance.
+    ///
+    /// \param [in] relative is the allowed relative difference from the
+    ///     estimate (e.g. 0.5 for 50%).
+    /// \param [in] absoluteLux is the allowed absolute difference; the
+    ///     larger of the two applies, so that dim light isn't flagged
+    ///     for noise.
+    ///
+    void setOutlierTolerance(float relative, float absoluteLux)
+        {
+        this->m_relTolerance = relative;
+        this->m_absTolerance = absoluteLux;
+        }
+
+    ///
+    /// \brief record a sample from a sensor.
+    ///
+    /// \param [in] i is the sensor index.
+    /// \param [in] nowMs is the time of the sample.
+    /// \param [in] lux is the sensor's (uncalibrated) lux.
+    ///
+    /// \return \c true for success, \c false if \p i is out of range.
+    ///
+    bool setSample(unsigned i, std::uint32_t nowMs, float lux)
+        {
+        if (i >= kSensors)
+            return false;
+
+        auto &s = this->m_sensor[i];
+        s.lux = lux * s.calibration;
+        s.time = nowMs;
+        s.fValid = true;
+        return true;
+        }
+
+    /// \brief forget the sample from a sensor (e.g. after an error).
+    void clearSample(unsigned i)
+        {
+        if (i < kSensors)
+            this->m_sensor[i].fValid = false;
+        }
+
+    ///
+    /// \brief combine the current samples.
+    ///
+    /// \param [in] nowMs is the current time.
+    /// \param [in] maxAgeMs is the oldest sample that is used.
+    /// \param [out] result receives the estimate and flags.
+    ///
+    /// \return \c true if at least one sample was used.
+    ///
+    bool fuse(std::uint32_t nowMs, std::uint32_t maxAgeMs, Result_t &result) const
+        {
+        std::uint8_t order[kSensors];
+        unsigned n = 0;
+
+        result = Result_t { 0.0f, 0, 0, 0 };
+
+        // collect current samples, sorted by calibrated lux.
+        for (unsigned i = 0; i < kSensors; ++i)
+            {
+            auto const &s = this->m_sensor[i];
+
+            if (! s.fValid || s.weight <= 0.0f || std::uint32_t(nowMs - s.time) > maxAgeMs)
+                continue;
+
+            unsigned j = n++;
+            for (; j > 0 && this->m_sensor[order[j - 1]].lux > s.lux; --j)
+                order[j] = order[j - 1];
+            order[j] = std::uint8_t(i);
+
+            result.usedMask |= std::uint32_t(1) << i;
+            }
+
+        result.nUsed = std::uint8_t(n);
+        if (n == 0)
+            return false;
+
+        result.lux = (this->m_method == Method::Median) ? this->weightedMedian(order, n)
+                                                       : this->trimmedMean(order, n);
+
+        // flag the sensors that disagree.
+        float tolerance = this->m_relTolerance * result.lux;
+        if (tolerance < this->m_absTolerance)
+            tolerance = this->m_absTolerance;
+
+        for (unsigned k = 0; k < n; ++k)
+            {
+            float const d = this->m_sensor[order[k]].lux - result.lux;
+
+            if (d > tolerance || -d > tolerance)
+                result.outlierMask |= std::uint32_t(1) << order[k];
+            }
+
+        return true;
+        }
+
+protected:
+    /// \brief return the weighted median of sorted samples.
+    float weightedMedian(const std::uint8_t *order, unsigned n) const
+        {
+        float total = 0.0f;
+        for (unsigned k = 0; k < n; ++k)
+            total += this->m_sensor[order[k]].weight;
+
+        // the first sample at which the cumulative weight reaches half;
+        // average with the next if it lands exactly on half.
+        float cumulative = 0.0f;
+        for (unsigned k = 0; k < n; ++k)
+            {
+            cumulative += this->m_sensor[order[k]].weight;
+
+            if (cumulative * 2.0f == total && k + 1 < n)
+                return (this->m_sensor[order[k]].lux + this->m_sensor[order[k + 1]].lux) / 2.0f;
+            if (cumulative * 2.0f > total)
+                return this->m_sensor[order[k]].lux;
+            }
+
+        return this->m_sensor[order[n - 1]].lux;
+        }
+
+    /// \brief return the weighted mean of sorted samples, without the extremes.
+    float trimmedMean(const std::uint8_t *order, unsigned n) const
+        {
+        // always keep at least one (or two, if n is even) samples.
+        unsigned trim = this->m_nTrim;
+        if (2 * trim >= n)
+            trim = (n - 1) / 2;
+
+        float sum = 0.0f;
+        float total = 0.0f;
+        for (unsigned k = trim; k < n - trim; ++k)
+            {
+            auto const &s = this->m_sensor[order[k]];
+
+            sum += s.weight * s.lux;
+            total += s.weight;
+            }
+
+        return sum / total;
+        }
+
+private:
+    /// \brief per-sensor state
+    struct Sensor_t
+        {
+        float           lux;            ///< calibrated lux of the last sample
+        float           calibration;    ///< calibration factor
+        float           weight;         ///< weight in the combination
+        std::uint32_t   time;           ///< time of the last sample
+        bool            fValid;         ///< true if lux is valid
+        };
+
+    Sensor_t        m_sensor[kSensors];         ///< the sensors
+    float           m_relTolerance = 0.5f;      ///< relative outlier tolerance
+    float           m_absTolerance = 1.0f;      ///< absolute outlier tolerance, lux
+    Method          m_method = Method::Median;  ///< combining method
+    std::uint8_t    m_nTrim = 1;                ///< samples trimmed from each end
+    };
+
+} // end namespace Mcci_Ltr_329als
+
+#endif /* _mcci_ltr_329als_fusion_h_ */
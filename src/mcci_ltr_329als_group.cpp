@@ -0,0 +1,394 @@
+/*
+
+Module: mcci_ltr_329als_group.cpp
+
+Function:
+    Implementation code for groups of LTR-329ALS sensors.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "mcci_ltr_329als_group.h"
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+bool Ltr_329alsGroup::add(Ltr_329als &sensor, std::uint8_t channel)
+    {
+    if (this->m_nSensors >= kMaxSensors || channel >= this->m_mux.getChannelCount())
+        return false;
+
+    std::uint32_t const bit = std::uint32_t(1) << channel;
+    if (this->m_allMask & bit)
+        return false;
+
+    this->m_pSensor[this->m_nSensors] = &sensor;
+    this->m_channel[this->m_nSensors] = channel;
+    ++this->m_nSensors;
+    this->m_allMask |= bit;
+    return true;
+    }
+
+/*
+
+Name:	Ltr_329alsGroup::begin()
+
+Function:
+    Start all sensors of the group, with overlapping delays.
+
+Definition:
+    bool Ltr_329alsGroup::begin(
+        void
+        );
+
+Description:
+    Ltr_329als::startBegin() is run for every sensor, and then
+    Ltr_329als::queryBeginDone() is run for each sensor in turn
+    until all are done, calling yield() after each round. The
+    sensors were all powered up together, so their power-on, reset
+    and wakeup delays overlap. A sensor's mux channel is only
+    selected when its state machine has something to do.
+
+    A sensor that fails is left out of the remaining rounds.
+
+Returns:
+    true if all sensors started, false otherwise.
+
+*/
+
+#define FUNCTION "Ltr_329alsGroup::begin"
+
+bool
+Ltr_329alsGroup::begin(
+    void
+    )
+    {
+    std::uint32_t pending = 0;
+
+    this->m_failedMask = 0;
+    this->m_readyMask = 0;
+
+    for (unsigned i = 0; i < this->m_nSensors; ++i)
+        {
+        std::uint32_t const bit = std::uint32_t(1) << i;
+
+        if (this->m_pSensor[i]->startBegin())
+            pending |= bit;
+        else
+            this->m_failedMask |= bit;
+        }
+
+    while (pending != 0)
+        {
+        for (unsigned i = 0; i < this->m_nSensors; ++i)
+            {
+            std::uint32_t const bit = std::uint32_t(1) << i;
+
+            if (! (pending & bit))
+                continue;
+
+            auto &sensor = *this->m_pSensor[i];
+            bool fError;
+
+            if (sensor.isBeginWaiting(millis()))
+                continue;
+
+            if (! this->select(i))
+                {
+                sensor.setLastError(Ltr_329als::Error::I2cWriteFailed);
+                sensor.setState(Ltr_329als::State::Uninitialized);
+                fError = true;
+                }
+            else if (sensor.queryBeginDone(fError))
+                {
+                pending &= ~bit;
+                continue;
+                }
+
+            if (fError)
+                {
+                pending &= ~bit;
+                this->m_failedMask |= bit;
+                }
+            }
+
+        if (pending != 0)
+            yield();
+        }
+
+    return this->m_failedMask == 0;
+    }
+
+#undef FUNCTION
+
+bool Ltr_329alsGroup::select(unsigned i)
+    {
+    if (i >= this->m_nSensors)
+        return false;
+
+    return this->m_mux.select(std::uint32_t(1) << this->m_channel[i]);
+    }
+
+bool Ltr_329alsGroup::configure(
+    AlsGain_t::Gain_t g,
+    AlsMeasRate_t::Rate_t r,
+    AlsMeasRate_t::Integration_t iTime
+    )
+    {
+    bool fResult = true;
+
+    for (unsigned i = 0; i < this->m_nSensors; ++i)
+        {
+        if (! this->m_pSensor[i]->configure(g, r, iTime))
+            fResult = false;
+        }
+
+    return fResult;
+    }
+
+/*
+
+Name:	Ltr_329alsGroup::startMeasurement()
+
+Function:
+    Start all sensors of the group with one broadcast.
+
+Definition:
+    bool Ltr_329alsGroup::startMeasurement(
+        bool fSingle
+        );
+
+Description:
+    Every sensor must be idle. The channels of all sensors are
+    enabled, and the first sensor's driver starts the measurement;
+    its writes to ALS_MEAS_RATE and ALS_CONTR reach every sensor.
+    The other drivers are then updated as if they had made the same
+    writes at the same time.
+
+Returns:
+    true for success, false for failure. The last error is set in
+    the driver that failed.
+
+*/
+
+#define FUNCTION "Ltr_329alsGroup::startMeasurement"
+
+bool
+Ltr_329alsGroup::startMeasurement(
+    bool fSingle
+    )
+    {
+    if (this->m_nSensors == 0)
+        return false;
+
+    auto &leader = *this->m_pSensor[0];
+
+    for (unsigned i = 0; i < this->m_nSensors; ++i)
+        {
+        auto &sensor = *this->m_pSensor[i];
+
+        if (! sensor.checkRunning())
+            return false;
+        if (sensor.getState() != Ltr_329als::State::Idle)
+            return sensor.setLastError(Ltr_329als::Error::Busy);
+        }
+
+    if (! this->selectAll())
+        return leader.setLastError(Ltr_329als::Error::I2cWriteFailed);
+
+    // the broadcast uses the leader's register images; make them common.
+    for (unsigned i = 1; i < this->m_nSensors; ++i)
+        {
+        auto &sensor = *this->m_pSensor[i];
+
+        sensor.m_control = leader.m_control;
+        sensor.m_measrate = leader.m_measrate;
+        sensor.m_userGain = leader.m_userGain;
+        }
+
+    if (! leader.startMeasurement(fSingle))
+        return false;
+
+    for (unsigned i = 1; i < this->m_nSensors; ++i)
+        {
+        this->m_pSensor[i]->markActive(
+            leader.m_sensorMeasRate,
+            leader.getState(),
+            leader.m_startTime
+            );
+        }
+
+    this->m_readyMask = 0;
+    this->m_errorMask = 0;
+    return true;
+    }
+
+#undef FUNCTION
+
+/*
+
+Name:	Ltr_329alsGroup::stopMeasurement()
+
+Function:
+    Stop measurements on all sensors of the group.
+
+Definition:
+    bool Ltr_329alsGroup::stopMeasurement(
+        void
+        );
+
+Description:
+    Each running driver ends its measurement bookkeeping as
+    Ltr_329als::stopMeasurement() does. If every sensor is then to
+    get the same ALS_CONTR value, the channels of all sensors are
+    enabled and the leader writes it once. If a member's gain has
+    moved away from the leader's (after HDR mode, or a burst change
+    on that member alone), each sensor is put in standby with its
+    own value instead.
+
+Returns:
+    true for success, false for failure. The last error is set in
+    the driver that failed.
+
+*/
+
+#define FUNCTION "Ltr_329alsGroup::stopMeasurement"
+
+bool
+Ltr_329alsGroup::stopMeasurement(
+    void
+    )
+    {
+    if (this->m_nSensors == 0)
+        return false;
+
+    auto &leader = *this->m_pSensor[0];
+    auto const control = leader.m_control.setActive(false);
+    std::uint32_t stopMask = 0;
+    bool fCommon = true;
+
+    this->m_readyMask = 0;
+    this->m_errorMask = 0;
+
+    for (unsigned i = 0; i < this->m_nSensors; ++i)
+        {
+        auto &sensor = *this->m_pSensor[i];
+
+        if (sensor.isRunning() && sensor.prepareStop())
+            stopMask |= std::uint32_t(1) << i;
+
+        if (sensor.m_control.setActive(false).getValue() != control.getValue())
+            fCommon = false;
+        }
+
+    if (stopMask == 0)
+        return true;
+
+    bool fResult = true;
+
+    if (! fCommon)
+        {
+        for (unsigned i = 0; i < this->m_nSensors; ++i)
+            {
+            auto &sensor = *this->m_pSensor[i];
+
+            if (! (stopMask & (std::uint32_t(1) << i)))
+                continue;
+
+            if (! this->select(i))
+                {
+                sensor.setLastError(Ltr_329als::Error::I2cWriteFailed);
+                sensor.setState(Ltr_329als::State::Uninitialized);
+                fResult = false;
+                }
+            else if (! sensor.setStandby())
+                fResult = false;
+            }
+
+        return fResult;
+        }
+
+    if (! this->selectAll())
+        {
+        leader.setLastError(Ltr_329als::Error::I2cWriteFailed);
+        fResult = false;
+        }
+    else
+        fResult = leader.writeRegister(Ltr_329als::Register_t::ALS_CONTR, control.getValue());
+
+    for (unsigned i = 0; i < this->m_nSensors; ++i)
+        {
+        if (stopMask & (std::uint32_t(1) << i))
+            this->m_pSensor[i]->setState(fResult ? Ltr_329als::State::Idle : Ltr_329als::State::Uninitialized);
+        }
+
+    return fResult;
+    }
+
+#undef FUNCTION
+
+bool Ltr_329alsGroup::queryReady(unsigned i, bool &fError)
+    {
+    if (i >= this->m_nSensors)
+        {
+        fError = true;
+        return false;
+        }
+
+    auto &sensor = *this->m_pSensor[i];
+
+    if (! this->select(i))
+        {
+        fError = true;
+        return sensor.setLastError(Ltr_329als::Error::I2cWriteFailed);
+        }
+
+    return sensor.queryReady(fError);
+    }
+
+bool Ltr_329alsGroup::queryAllReady(bool &fError)
+    {
+    fError = false;
+
+    // a new round.
+    if (this->m_readyMask == 0)
+        this->m_errorMask = 0;
+
+    for (unsigned i = 0; i < this->m_nSensors; ++i)
+        {
+        std::uint32_t const bit = std::uint32_t(1) << i;
+        bool fSensorError;
+
+        if (this->m_readyMask & bit)
+            continue;
+
+        if (this->queryReady(i, fSensorError))
+            this->m_readyMask |= bit;
+        else if (fSensorError)
+            {
+            // it won't report; count it as done, so the round can end.
+            this->m_readyMask |= bit;
+            this->m_errorMask |= bit;
+            fError = true;
+            }
+        }
+
+    if (this->m_readyMask != (std::uint32_t(1) << this->m_nSensors) - 1)
+        return false;
+
+    this->m_readyMask = 0;
+    fError = this->m_errorMask != 0;
+    return true;
+    }
+
+/**** end of mcci_ltr_329als_group.cpp ****/
@@ -0,0 +1,218 @@
+/*
+
+Module: mcci_ltr_329als_group.h
+
+Function:
+    Groups of LTR-329ALS sensors behind an I2C multiplexer.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+/// \file
+
+#ifndef _mcci_ltr_329als_group_h_
+#define _mcci_ltr_329als_group_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <cstdint>
+#include "mcci_ltr_329als.h"
+#include "mcci_ltr_329als_mux.h"
+
+namespace Mcci_Ltr_329als {
+
+///
+/// \brief Several LTR-329ALS sensors on the channels of one multiplexer.
+///
+/// \details
+///     All the sensors share the multiplexer's upstream bus, and each
+///     has its own Ltr_329als driver. The group starts and stops
+///     measurements with broadcast writes: it enables every member's
+///     channel at once, so a single \c ALS_MEAS_RATE and \c ALS_CONTR
+///     write starts all sensors in the same integration window. It then
+///     selects each sensor's channel in turn to read the results.
+///
+///     All members use the configuration set by configure().
+///
+class Ltr_329alsGroup
+    {
+public:
+    /// \brief the largest number of sensors in a group.
+    static constexpr unsigned kMaxSensors = 8;
+
+    ///
+    /// \brief the constructor
+    ///
+    /// \param [in] mux is the multiplexer; it must be able to enable
+    ///     several channels at once.
+    ///
+    Ltr_329alsGroup(I2cMux_t &mux)
+        : m_mux(mux)
+        {}
+
+    // neither copyable nor movable
+    Ltr_329alsGroup(const Ltr_329alsGroup&) = delete;
+    Ltr_329alsGroup& operator=(const Ltr_329alsGroup&) = delete;
+    Ltr_329alsGroup(const Ltr_329alsGroup&&) = delete;
+    Ltr_329alsGroup& operator=(const Ltr_329alsGroup&&) = delete;
+
+    ///
+    /// \brief add a sensor to the group.
+    ///
+    /// \param [in] sensor is the driver; it must use the multiplexer's
+    ///     upstream bus.
+    /// \param [in] channel is the multiplexer channel of the sensor.
+    ///
+    /// \return \c true for success, \c false if the group is full or the
+    ///     channel is invalid or already used.
+    ///
+    bool add(Ltr_329als &sensor, std::uint8_t channel);
+
+    /// \brief return the number of sensors in the group.
+    unsigned getCount() const
+        {
+        return this->m_nSensors;
+        }
+
+    /// \brief return a sensor; \p i must be less than getCount().
+    Ltr_329als &getSensor(unsigned i)
+        {
+        return *this->m_pSensor[i];
+        }
+
+    ///
+    /// \brief start all sensors of the group.
+    ///
+    /// \return
+    ///     \c true if every sensor started. \c false if any failed; the
+    ///     others are still started, and the failing drivers have
+    ///     their last error set (see getFailedMask()).
+    ///
+    /// \details
+    ///     This is equivalent to calling Ltr_329als::begin() for each
+    ///     sensor, but the start-up delays overlap: the sensors' start-up
+    ///     state machines (Ltr_329als::queryBeginDone()) are run in turn
+    ///     until all are done. The time taken doesn't grow with the
+    ///     number of sensors.
+    ///
+    bool begin();
+
+    ///
+    /// \brief return the sensors that failed in the last begin().
+    ///
+    /// \return a mask with bit \c i set if sensor \c i failed.
+    ///
+    std::uint32_t getFailedMask() const
+        {
+        return this->m_failedMask;
+        }
+
+    ///
+    /// \brief enable the channel of one sensor, so it can be used directly.
+    ///
+    /// \return \c true for success.
+    ///
+    bool select(unsigned i);
+
+    /// \brief enable the channels of all sensors, for broadcast writes.
+    bool selectAll()
+        {
+        return this->m_mux.select(this->m_allMask);
+        }
+
+    ///
+    /// \brief configure all sensors.
+    ///
+    /// \return \c true for success; \c false if any sensor rejects the
+    ///     configuration (see its last error).
+    ///
+    /// \details
+    ///     Like Ltr_329als::configure(), this only updates the drivers'
+    ///     register images; the registers are written (once, by
+    ///     broadcast) when measurement starts.
+    ///
+    bool configure(AlsGain_t::Gain_t g, AlsMeasRate_t::Rate_t r, AlsMeasRate_t::Integration_t iTime);
+
+    ///
+    /// \brief start a measurement on all sensors at once.
+    ///
+    /// \param [in] fSingle is \c true for single measurements, \c false
+    ///     for continuous.
+    ///
+    /// \return
+    ///     \c true for success. \c false if a sensor isn't idle or a
+    ///     bus error occurs; the last error is set in the failing driver.
+    ///
+    bool startMeasurement(bool fSingle = true);
+
+    ///
+    /// \brief stop measurements on all sensors at once.
+    ///
+    /// \return \c true for success.
+    ///
+    /// \details
+    ///     Each driver is left as Ltr_329als::stopMeasurement() leaves it.
+    ///     One broadcast write stops all sensors, unless their gains
+    ///     differ (for example, after HDR mode); then each is stopped
+    ///     in turn.
+    ///
+    bool stopMeasurement();
+
+    ///
+    /// \brief poll one sensor.
+    ///
+    /// \param [in] i is the sensor index.
+    /// \param [out] fError is set \c true if a hard error occurred.
+    ///
+    /// \return as for Ltr_329als::queryReady().
+    ///
+    bool queryReady(unsigned i, bool &fError);
+
+    ///
+    /// \brief poll every sensor that hasn't reported yet.
+    ///
+    /// \param [out] fError is set \c true if a hard error occurred on
+    ///     any sensor.
+    ///
+    /// \return
+    ///     \c true once every sensor has reported a sample or failed
+    ///     since the measurement started (or since the previous \c true
+    ///     result). Each sensor's sample is then in its driver. A sensor
+    ///     that failed counts as done, so that the others keep
+    ///     reporting; \p fError is set on the call that finds the
+    ///     failure and on the \c true result, and getErrorMask() tells
+    ///     which sensors failed.
+    ///
+    bool queryAllReady(bool &fError);
+
+    ///
+    /// \brief return the sensors that failed in the current or last
+    ///     round of queryAllReady().
+    ///
+    /// \return a mask with bit \c i set if sensor \c i had a hard error;
+    ///     its driver has the last error set.
+    ///
+    std::uint32_t getErrorMask() const
+        {
+        return this->m_errorMask;
+        }
+
+private:
+    I2cMux_t        &m_mux;                         ///< the multiplexer
+    Ltr_329als      *m_pSensor[kMaxSensors];        ///< the sensors
+    std::uint8_t    m_channel[kMaxSensors];         ///< mux channel of each sensor
+    std::uint32_t   m_allMask = 0;                  ///< channels of all sensors
+    std::uint32_t   m_readyMask = 0;                ///< sensors that have reported
+    std::uint32_t   m_failedMask = 0;               ///< sensors that failed to begin
+    std::uint32_t   m_errorMask = 0;                ///< sensors that failed in queryAllReady()
+    std::uint8_t    m_nSensors = 0;                 ///< number of sensors
+    };
+
+} // end namespace Mcci_Ltr_329als
+
+#endif /* _mcci_ltr_329als_group_h_ */
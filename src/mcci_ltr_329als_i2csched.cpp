@@ -0,0 +1,206 @@
+/*
+
+Module: mcci_ltr_329als_i2csched.cpp
+
+Function:
+    Implementation code for the I2C transaction scheduler.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "mcci_ltr_329als_i2csched.h"
+#include <Arduino.h>
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+bool I2cScheduler_t::submit(Transaction_t &t)
+    {
+    if (t.pWire == nullptr || t.status == Status::Pending)
+        return false;
+
+    t.status = Status::Pending;
+    t.pNext = this->m_pHead;
+    this->m_pHead = &t;
+    return true;
+    }
+
+bool I2cScheduler_t::transfer(Transaction_t &t)
+    {
+    if (t.pWire == nullptr || t.status == Status::Pending)
+        return false;
+
+    // run anything queued that's more urgent than this.
+    for (;;)
+        {
+        auto const now = millis();
+        auto pNext = this->dequeue(now);
+
+        if (pNext == nullptr)
+            break;
+
+        if (! isMoreUrgent(*pNext, t, now))
+            {
+            // put it back; order in the queue doesn't matter.
+            pNext->pNext = this->m_pHead;
+            this->m_pHead = pNext;
+            break;
+            }
+
+        complete(*pNext);
+        }
+
+    execute(t);
+    return t.status == Status::Success;
+    }
+
+bool I2cScheduler_t::poll()
+    {
+    auto pNext = this->dequeue(millis());
+
+    if (pNext == nullptr)
+        return false;
+
+    complete(*pNext);
+    return true;
+    }
+
+bool I2cScheduler_t::cancel(Transaction_t &t)
+    {
+    for (auto pp = &this->m_pHead; *pp != nullptr; pp = &(*pp)->pNext)
+        {
+        if (*pp == &t)
+            {
+            *pp = t.pNext;
+            t.pNext = nullptr;
+            t.status = Status::Cancelled;
+            return true;
+            }
+        }
+
+    return false;
+    }
+
+bool I2cScheduler_t::hasWorkAbove(std::uint8_t priority) const
+    {
+    Transaction_t probe;
+    auto const now = millis();
+
+    probe.priority = priority;
+    for (auto p = this->m_pHead; p != nullptr; p = p->pNext)
+        {
+        if (isMoreUrgent(*p, probe, now))
+            return true;
+        }
+
+    return false;
+    }
+
+// protected
+bool I2cScheduler_t::isMoreUrgent(const Transaction_t &a, const Transaction_t &b, std::uint32_t now)
+    {
+    bool const fDueA = a.fDeadline && std::int32_t(a.deadline - now) <= 0;
+    bool const fDueB = b.fDeadline && std::int32_t(b.deadline - now) <= 0;
+
+    if (fDueA != fDueB)
+        return fDueA;
+
+    if (a.priority != b.priority)
+        return a.priority > b.priority;
+
+    if (a.fDeadline != b.fDeadline)
+        return a.fDeadline;
+
+    return a.fDeadline && std::int32_t(a.deadline - b.deadline) < 0;
+    }
+
+// protected
+I2cScheduler_t::Transaction_t *I2cScheduler_t::dequeue(std::uint32_t now)
+    {
+    Transaction_t **ppBest = nullptr;
+
+    for (auto pp = &this->m_pHead; *pp != nullptr; pp = &(*pp)->pNext)
+        {
+        if (ppBest == nullptr || isMoreUrgent(**pp, **ppBest, now))
+            ppBest = pp;
+        }
+
+    if (ppBest == nullptr)
+        return nullptr;
+
+    auto const pBest = *ppBest;
+    *ppBest = pBest->pNext;
+    pBest->pNext = nullptr;
+    return pBest;
+    }
+
+// protected
+void I2cScheduler_t::execute(Transaction_t &t)
+    {
+    auto const pWire = t.pWire;
+
+    t.nRxDone = 0;
+    if (t.nTx != 0)
+        {
+        pWire->beginTransmission(t.address);
+        if (pWire->write(t.pTx, t.nTx) != t.nTx)
+            {
+            t.status = Status::WriteBufferFailed;
+            return;
+            }
+        if (pWire->endTransmission() != 0)
+            {
+            t.status = Status::WriteFailed;
+            return;
+            }
+        }
+
+    if (t.nRx != 0)
+        {
+        t.nRxDone = pWire->requestFrom(t.address, t.nRx);
+        if (t.nRxDone != t.nRx)
+            {
+            t.status = Status::ReadRequestFailed;
+            return;
+            }
+
+        auto const nResult = unsigned(pWire->available());
+        if (nResult > t.nRx)
+            {
+            t.status = Status::ReadLong;
+            return;
+            }
+
+        for (unsigned i = 0; i < nResult; ++i)
+            t.pRx[i] = pWire->read();
+
+        if (nResult != t.nRx)
+            {
+            t.status = Status::ReadShort;
+            return;
+            }
+        }
+
+    t.status = Status::Success;
+    }
+
+// protected
+void I2cScheduler_t::complete(Transaction_t &t)
+    {
+    execute(t);
+
+    if (t.pDone != nullptr)
+        t.pDone(&t, t.pContext);
+    }
+
+/**** end of mcci_ltr_329als_i2csched.cpp ****/
@@ -0,0 +1,164 @@
+/*
+
+Module: mcci_ltr_329als_i2csched.h
+
+Function:
+    Prioritized I2C transaction scheduler for shared buses.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+/// \file
+
+#ifndef _mcci_ltr_329als_i2csched_h_
+#define _mcci_ltr_329als_i2csched_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <Wire.h>
+
+namespace Mcci_Ltr_329als {
+
+///
+/// \brief Schedule I2C transactions from several clients on one bus.
+///
+/// \details
+///     Clients describe each bus operation with a Transaction_t: an
+///     optional write phase followed by an optional read phase, a
+///     priority and an optional deadline. Transactions are owned by
+///     the caller; the scheduler links queued transactions into a
+///     list, so no memory is allocated.
+///
+///     Two transport modes are supported, and may be mixed on the
+///     same bus:
+///
+///     - **Split-phase**: submit() queues a transaction and returns
+///       at once. The application calls poll() (for example from
+///       \c loop()) to run the most urgent queued transaction; on
+///       completion, the transaction's callback is invoked.
+///     - **Synchronous**: transfer() runs a transaction before
+///       returning. First, though, it runs every queued transaction
+///       that is more urgent, so that (say) an FRAM write with a
+///       deadline isn't held up behind sensor status polling.
+///
+///     A transaction is more urgent than another if its deadline has
+///     arrived and the other's hasn't; otherwise if it has higher
+///     priority; otherwise if it has the earlier deadline.
+///
+///     Ltr_329als::setScheduler() makes the light-sensor driver send
+///     its register transfers through a scheduler, synchronously.
+///
+class I2cScheduler_t
+    {
+public:
+    /// \brief outcome of a transaction
+    enum class Status : std::uint8_t
+        {
+        Idle = 0,           ///< not yet submitted
+        Pending,            ///< queued, waiting to run
+        Success,            ///< completed successfully
+        WriteBufferFailed,  ///< couldn't fill the write buffer
+        WriteFailed,        ///< write phase was not acknowledged
+        ReadRequestFailed,  ///< read phase returned the wrong count
+        ReadShort,          ///< too few bytes available
+        ReadLong,           ///< too many bytes available
+        Cancelled,          ///< removed from the queue by cancel()
+        };
+
+    /// \brief a bus transaction
+    struct Transaction_t
+        {
+        /// \brief completion callback type
+        using DoneFn_t = void (Transaction_t *pTransaction, void *pContext);
+
+        TwoWire         *pWire = nullptr;       ///< the bus to use
+        const std::uint8_t *pTx = nullptr;      ///< bytes to write, or \c nullptr
+        std::uint8_t    *pRx = nullptr;         ///< buffer for bytes read, or \c nullptr
+        DoneFn_t        *pDone = nullptr;       ///< completion callback, or \c nullptr
+        void            *pContext = nullptr;    ///< context for callback
+        Transaction_t   *pNext = nullptr;       ///< link in queue (internal)
+        std::uint32_t   deadline = 0;           ///< deadline (in millis()), if fDeadline
+        std::uint8_t    nTx = 0;                ///< number of bytes to write
+        std::uint8_t    nRx = 0;                ///< number of bytes to read
+        std::uint8_t    nRxDone = 0;            ///< number of bytes the read phase returned
+        std::uint8_t    address = 0;            ///< 7-bit I2C address
+        std::uint8_t    priority = 0;           ///< priority; larger is more urgent
+        bool            fDeadline = false;      ///< true if deadline is valid
+        volatile Status status = Status::Idle;  ///< outcome
+        };
+
+    I2cScheduler_t() = default;
+
+    // neither copyable nor movable
+    I2cScheduler_t(const I2cScheduler_t&) = delete;
+    I2cScheduler_t& operator=(const I2cScheduler_t&) = delete;
+    I2cScheduler_t(const I2cScheduler_t&&) = delete;
+    I2cScheduler_t& operator=(const I2cScheduler_t&&) = delete;
+
+    ///
+    /// \brief queue a transaction for split-phase execution.
+    ///
+    /// \return \c true if queued, \c false if the transaction is
+    ///     already queued or has no bus.
+    ///
+    bool submit(Transaction_t &t);
+
+    ///
+    /// \brief run a transaction synchronously.
+    ///
+    /// \details
+    ///     Queued transactions that are more urgent run first.
+    ///
+    /// \return \c true if the transaction succeeded.
+    ///
+    bool transfer(Transaction_t &t);
+
+    ///
+    /// \brief run the most urgent queued transaction, if any.
+    ///
+    /// \return \c true if a transaction was run.
+    ///
+    bool poll();
+
+    /// \brief remove a queued transaction; returns \c true if it was queued.
+    bool cancel(Transaction_t &t);
+
+    /// \brief return \c true if no transactions are queued.
+    bool isIdle() const
+        {
+        return this->m_pHead == nullptr;
+        }
+
+    ///
+    /// \brief return \c true if queued work is more urgent than a
+    ///     transaction with the given priority and no deadline.
+    ///
+    bool hasWorkAbove(std::uint8_t priority) const;
+
+protected:
+    /// \brief compare urgency of two transactions at time \p now.
+    static bool isMoreUrgent(const Transaction_t &a, const Transaction_t &b, std::uint32_t now);
+
+    /// \brief find and unlink the most urgent queued transaction.
+    Transaction_t *dequeue(std::uint32_t now);
+
+    /// \brief perform a transaction on the bus.
+    static void execute(Transaction_t &t);
+
+    /// \brief run a dequeued transaction and call its callback.
+    static void complete(Transaction_t &t);
+
+private:
+    Transaction_t   *m_pHead = nullptr;     ///< queued transactions, unordered
+    };
+
+} // end namespace Mcci_Ltr_329als
+
+#endif /* _mcci_ltr_329als_i2csched_h_ */
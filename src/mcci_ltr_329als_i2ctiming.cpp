@@ -0,0 +1,76 @@
+/*
+
+Module: mcci_ltr_329als_i2ctiming.cpp
+
+Function:
+    Implementation code for the I2C bus timing model.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "mcci_ltr_329als_i2ctiming.h"
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+void I2cBusTiming_t::setClock(std::uint32_t sclHz)
+    {
+    if (sclHz == 0)
+        sclHz = 100000;
+
+    this->m_sclHz = sclHz;
+    this->m_bitNs = (1000000000u + sclHz - 1) / sclHz;
+
+    // minimum timings from the I2C specification (UM10204, table 10).
+    if (sclHz <= 100000)
+        {
+        this->m_startNs = 4000;
+        this->m_setupStartNs = 4700;
+        this->m_stopNs = 4000;
+        this->m_freeNs = 4700;
+        }
+    else if (sclHz <= 400000)
+        {
+        this->m_startNs = 600;
+        this->m_setupStartNs = 600;
+        this->m_stopNs = 600;
+        this->m_freeNs = 1300;
+        }
+    else
+        {
+        this->m_startNs = 260;
+        this->m_setupStartNs = 260;
+        this->m_stopNs = 260;
+        this->m_freeNs = 500;
+        }
+    }
+
+I2cBusTiming_t::ns_t I2cBusTiming_t::transferNs(std::size_t nBytes, bool fRepeatedStart) const
+    {
+    // address byte plus data bytes, each with ACK and clock stretching.
+    ns_t const nFrames = ns_t(nBytes) + 1;
+    ns_t result = nFrames * (9 * this->m_bitNs + this->m_stretchNs);
+
+    // START; a repeated START also needs setup time.
+    result += this->m_startNs;
+    if (this->m_fRepeated)
+        result += this->m_setupStartNs;
+
+    // STOP and bus free time, unless we're holding the bus.
+    if (! fRepeatedStart)
+        result += this->m_stopNs + this->m_freeNs;
+
+    return result;
+    }
+
+/**** end of mcci_ltr_329als_i2ctiming.cpp ****/
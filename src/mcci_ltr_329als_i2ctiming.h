@@ -0,0 +1,161 @@
+/*
+
+Module: mcci_ltr_329als_i2ctiming.h
+
+Function:
+    I2C bus timing model for the MCCI LTR-329ALS library.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+/// \file
+
+#ifndef _mcci_ltr_329als_i2ctiming_h_
+#define _mcci_ltr_329als_i2ctiming_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace Mcci_Ltr_329als {
+
+///
+/// \brief Model the time an I2C bus is occupied by transfers.
+///
+/// \details
+///     Each transfer is modeled as a START (or repeated START), the
+///     address byte and each data byte (8 data bits plus ACK), any
+///     clock stretching by the target, a STOP and the bus free time
+///     before the next START. Setup and hold times are the minimums
+///     from the I2C specification for the speed mode implied by the
+///     SCL rate (standard, fast or fast-mode plus).
+///
+///     The model accumulates total bus occupancy, so it can be
+///     attached to one or more drivers (see Ltr_329als::setBusTiming())
+///     or to a simulated bus, and then used to work out how much
+///     traffic a bus can carry:
+///
+///     \code
+///     I2cBusTiming_t timing(400000);
+///     gLtr.setBusTiming(&timing);
+///     // ... run for a while ...
+///     auto ppm = I2cBusTiming_t::utilizationPpm(timing.getBusyNs(), elapsedUs * 1000);
+///     \endcode
+///
+class I2cBusTiming_t
+    {
+public:
+    /// \brief abstract type for times in nanoseconds.
+    using ns_t = std::uint32_t;
+
+    ///
+    /// \brief construct a model for a given SCL rate.
+    ///
+    /// \param [in] sclHz is the SCL clock rate in Hz.
+    /// \param [in] stretchNs is the clock stretching added by the
+    ///     target after each byte, in ns.
+    ///
+    I2cBusTiming_t(std::uint32_t sclHz = 100000, ns_t stretchNs = 0)
+        {
+        this->setClock(sclHz);
+        this->setClockStretch(stretchNs);
+        }
+
+    /// \brief set the SCL clock rate, in Hz.
+    void setClock(std::uint32_t sclHz);
+
+    /// \brief return the SCL clock rate, in Hz.
+    std::uint32_t getClock() const
+        {
+        return this->m_sclHz;
+        }
+
+    /// \brief set the clock stretching after each byte, in ns.
+    void setClockStretch(ns_t stretchNs)
+        {
+        this->m_stretchNs = stretchNs;
+        }
+
+    ///
+    /// \brief compute the bus time for one transfer.
+    ///
+    /// \param [in] nBytes is the number of data bytes, not including
+    ///     the address byte.
+    /// \param [in] fRepeatedStart is \c true if the transfer ends with
+    ///     a repeated START rather than a STOP (so there is no STOP and
+    ///     no bus free time, and the next transfer's START is a
+    ///     repeated START).
+    ///
+    /// \return the time the bus is occupied, in ns.
+    ///
+    /// \note if the previous transfer added with addTransfer() ended
+    ///     with a repeated START, this transfer begins with one.
+    ///
+    ns_t transferNs(std::size_t nBytes, bool fRepeatedStart = false) const;
+
+    /// \brief add a transfer to the accumulated occupancy.
+    void addTransfer(std::size_t nBytes, bool fRepeatedStart = false)
+        {
+        this->m_busyNs += this->transferNs(nBytes, fRepeatedStart);
+        this->m_fRepeated = fRepeatedStart;
+        ++this->m_nTransfers;
+        }
+
+    /// \brief return the accumulated bus occupancy, in ns.
+    std::uint64_t getBusyNs() const
+        {
+        return this->m_busyNs;
+        }
+
+    /// \brief return the number of transfers accumulated.
+    std::uint32_t getTransfers() const
+        {
+        return this->m_nTransfers;
+        }
+
+    /// \brief clear the accumulated occupancy.
+    void reset()
+        {
+        this->m_busyNs = 0;
+        this->m_nTransfers = 0;
+        this->m_fRepeated = false;
+        }
+
+    ///
+    /// \brief compute bus utilization.
+    ///
+    /// \param [in] busyNs is the bus occupancy, in ns.
+    /// \param [in] elapsedNs is the elapsed time, in ns.
+    ///
+    /// \return utilization in parts per million.
+    ///
+    static std::uint32_t utilizationPpm(std::uint64_t busyNs, std::uint64_t elapsedNs)
+        {
+        if (elapsedNs == 0)
+            return 0;
+
+        return std::uint32_t((busyNs * 1000000u) / elapsedNs);
+        }
+
+private:
+    std::uint64_t   m_busyNs = 0;       ///< accumulated bus occupancy
+    std::uint32_t   m_nTransfers = 0;   ///< number of transfers accumulated
+    std::uint32_t   m_sclHz;            ///< SCL clock rate
+    ns_t            m_bitNs;            ///< one SCL period
+    ns_t            m_startNs;          ///< START hold time (tHD;STA)
+    ns_t            m_setupStartNs;     ///< repeated START setup time (tSU;STA)
+    ns_t            m_stopNs;           ///< STOP setup time (tSU;STO)
+    ns_t            m_freeNs;           ///< bus free time between STOP and START (tBUF)
+    ns_t            m_stretchNs;        ///< clock stretching per byte
+    bool            m_fRepeated = false;    ///< next START is a repeated START
+    };
+
+} // end namespace Mcci_Ltr_329als
+
+#endif /* _mcci_ltr_329als_i2ctiming_h_ */
@@ -0,0 +1,47 @@
+/*
+
+Module: mcci_ltr_329als_mux.cpp
+
+Function:
+    Implementation code for the I2C multiplexer drivers.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "mcci_ltr_329als_mux.h"
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+bool Tca9548a_t::select(std::uint32_t channelMask)
+    {
+    if (channelMask >> kChannels)
+        return false;
+
+    auto const value = std::uint8_t(channelMask);
+    if (this->m_fKnown && value == this->m_selected)
+        return true;
+
+    this->m_wire->beginTransmission(this->m_address);
+    if (this->m_wire->write(value) != 1 || this->m_wire->endTransmission() != 0)
+        {
+        this->m_fKnown = false;
+        return false;
+        }
+
+    this->m_selected = value;
+    this->m_fKnown = true;
+    return true;
+    }
+
+/**** end of mcci_ltr_329als_mux.cpp ****/
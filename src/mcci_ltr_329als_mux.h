@@ -0,0 +1,105 @@
+/*
+
+Module: mcci_ltr_329als_mux.h
+
+Function:
+    I2C multiplexer abstraction for the MCCI LTR-329ALS library.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+/// \file
+
+#ifndef _mcci_ltr_329als_mux_h_
+#define _mcci_ltr_329als_mux_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <cstdint>
+#include <Wire.h>
+
+namespace Mcci_Ltr_329als {
+
+///
+/// \brief Abstract I2C multiplexer (switch).
+///
+/// \details
+///     Every LTR-329ALS answers at the same address, so several
+///     sensors on one bus must be behind a multiplexer. A switch that
+///     can enable more than one downstream channel at a time also
+///     allows broadcast writes: one write reaches every enabled sensor.
+///
+class I2cMux_t
+    {
+public:
+    virtual ~I2cMux_t() = default;
+
+    /// \brief return the number of downstream channels.
+    virtual unsigned getChannelCount() const = 0;
+
+    ///
+    /// \brief enable a set of downstream channels.
+    ///
+    /// \param [in] channelMask has bit \c i set to enable channel \c i.
+    ///
+    /// \return \c true for success, \c false for failure.
+    ///
+    virtual bool select(std::uint32_t channelMask) = 0;
+    };
+
+///
+/// \brief TCA9548A (and PCA9548A) 8-channel I2C switch.
+///
+/// \details
+///     The switch has a single control register; each bit enables one
+///     channel. The last selection is remembered, so selecting the same
+///     channels again costs no bus traffic.
+///
+class Tca9548a_t : public I2cMux_t
+    {
+public:
+    /// \brief the address of the switch with A2..A0 low.
+    static constexpr std::uint8_t kDefaultAddress = 0x70;
+
+    /// \brief the number of channels.
+    static constexpr unsigned kChannels = 8;
+
+    ///
+    /// \brief the constructor
+    ///
+    /// \param [in] wire is the upstream bus.
+    /// \param [in] address is the switch's I2C address, in [0x70, 0x77].
+    ///
+    Tca9548a_t(TwoWire &wire, std::uint8_t address = kDefaultAddress)
+        : m_wire(&wire)
+        , m_address(address)
+        {}
+
+    virtual unsigned getChannelCount() const override
+        {
+        return kChannels;
+        }
+
+    virtual bool select(std::uint32_t channelMask) override;
+
+    /// \brief forget the remembered selection (e.g. after the switch is reset).
+    void invalidate()
+        {
+        this->m_fKnown = false;
+        }
+
+private:
+    TwoWire         *m_wire;            ///< upstream bus
+    std::uint8_t    m_address;          ///< switch address
+    std::uint8_t    m_selected = 0;     ///< last value written
+    bool            m_fKnown = false;   ///< true if m_selected is current
+    };
+
+} // end namespace Mcci_Ltr_329als
+
+#endif /* _mcci_ltr_329als_mux_h_ */
@@ -0,0 +1,214 @@
+/*
+
+Module: mcci_ltr_329als_pyramid.cpp
+
+Function:
+    Implementation code for the summary pyramid.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "mcci_ltr_329als_pyramid.h"
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+void SummaryPyramid_t::reset()
+    {
+    unsigned offset = 0;
+
+    for (unsigned i = 0; i < kLevels; ++i)
+        {
+        auto &level = this->m_level[i];
+        auto const size = getRingSize(Level(i));
+
+        level.open.clear();
+        level.pRing = &this->m_ring[offset];
+        level.pRecent = &this->m_recent[offset];
+        level.index = 0;
+        level.seconds = getBucketSeconds(Level(i));
+        level.size = std::uint16_t(size);
+        level.head = 0;
+        level.nClosed = 0;
+        offset += size;
+        }
+
+    this->m_lastSec = 0;
+    this->m_fStarted = false;
+    }
+
+void SummaryPyramid_t::close(Level_t &level)
+    {
+    level.head = std::uint16_t(level.head + 1 == level.size ? 0 : level.head + 1);
+    level.pRing[level.head] = level.open;
+
+    // the newest i+1 buckets are the new one and the newest i before it.
+    unsigned i = level.nClosed < level.size ? level.nClosed : level.size - 1u;
+    for (; i > 0; --i)
+        {
+        level.pRecent[i] = level.open;
+        level.pRecent[i].merge(level.pRecent[i - 1]);
+        }
+    level.pRecent[0] = level.open;
+
+    if (level.nClosed < level.size)
+        ++level.nClosed;
+
+    level.open.clear();
+    }
+
+void SummaryPyramid_t::advance(std::uint32_t nowSec)
+    {
+    if (! this->m_fStarted)
+        {
+        for (auto &level : this->m_level)
+            level.index = nowSec / level.seconds;
+
+        this->m_lastSec = nowSec;
+        this->m_fStarted = true;
+        return;
+        }
+
+    if (nowSec <= this->m_lastSec)
+        return;
+
+    this->m_lastSec = nowSec;
+
+    for (auto &level : this->m_level)
+        {
+        std::uint32_t const index = nowSec / level.seconds;
+        std::uint32_t n = index - level.index;
+
+        // after the open bucket and a ring full of empty ones, more
+        // closes change nothing.
+        if (n > std::uint32_t(level.size) + 1)
+            n = std::uint32_t(level.size) + 1;
+
+        for (; n > 0; --n)
+            this->close(level);
+
+        level.index = index;
+        }
+    }
+
+bool SummaryPyramid_t::update(std::uint32_t nowSec, float lux)
+    {
+    if (this->m_fStarted && nowSec < this->m_lastSec)
+        return false;
+
+    this->advance(nowSec);
+
+    for (auto &level : this->m_level)
+        level.open.add(lux);
+
+    return true;
+    }
+
+/*
+
+Name:	SummaryPyramid_t::query()
+
+Function:
+    Summarize the samples of a recent period.
+
+Definition:
+    bool SummaryPyramid_t::query(
+        std::uint32_t nowSec,
+        std::uint32_t spanSec,
+        Summary_t &result
+        );
+
+Description:
+    For each level from the finest, we work out how many closed
+    buckets, together with the open bucket, cover the period. The
+    first level that keeps that many is used: the result is the
+    open bucket merged with the running summary of that many newest
+    closed buckets. No buckets are scanned.
+
+Returns:
+    true for success, false if the period is longer than the
+    coarsest level covers.
+
+*/
+
+#define FUNCTION "SummaryPyramid_t::query"
+
+bool
+SummaryPyramid_t::query(
+    std::uint32_t nowSec,
+    std::uint32_t spanSec,
+    Summary_t &result
+    )
+    {
+    this->advance(nowSec);
+    if (nowSec < this->m_lastSec)
+        nowSec = this->m_lastSec;
+
+    for (auto const &level : this->m_level)
+        {
+        std::uint32_t const openStart = level.index * level.seconds;
+        std::uint32_t const inOpen = nowSec - openStart;
+        std::uint32_t nClosed = 0;
+
+        if (spanSec > inOpen)
+            nClosed = (spanSec - inOpen + level.seconds - 1) / level.seconds;
+
+        if (nClosed > level.size)
+            continue;
+
+        Bucket_t bucket = level.open;
+        std::uint32_t const nValid = nClosed < level.nClosed ? nClosed : level.nClosed;
+
+        if (nValid > 0)
+            bucket.merge(level.pRecent[nValid - 1]);
+
+        toSummary(bucket, openStart - nClosed * level.seconds, result);
+        return true;
+        }
+
+    return false;
+    }
+
+#undef FUNCTION
+
+bool SummaryPyramid_t::getBucket(Level level, unsigned age, Summary_t &result) const
+    {
+    if (unsigned(level) >= kLevels)
+        return false;
+
+    auto const &l = this->m_level[unsigned(level)];
+
+    if (age == 0)
+        {
+        toSummary(l.open, l.index * l.seconds, result);
+        return true;
+        }
+
+    if (age > l.nClosed)
+        return false;
+
+    unsigned const i = (l.head + l.size - (age - 1)) % l.size;
+    toSummary(l.pRing[i], (l.index - age) * l.seconds, result);
+    return true;
+    }
+
+void SummaryPyramid_t::toSummary(const Bucket_t &bucket, std::uint32_t startSec, Summary_t &result)
+    {
+    result.min = bucket.min;
+    result.max = bucket.max;
+    result.mean = bucket.count != 0 ? float(double(bucket.sum) / bucket.count / 1000.0) : 0.0f;
+    result.count = bucket.count;
+    result.startSec = startSec;
+    }
+
+/**** end of mcci_ltr_329als_pyramid.cpp ****/
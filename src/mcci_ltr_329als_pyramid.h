@@ -0,0 +1,242 @@
+/*
+
+Module: mcci_ltr_329als_pyramid.h
+
+Function:
+    Multi-resolution min/max/mean summaries for the MCCI LTR-329ALS library.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+/// \file
+
+#ifndef _mcci_ltr_329als_pyramid_h_
+#define _mcci_ltr_329als_pyramid_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <cstdint>
+
+namespace Mcci_Ltr_329als {
+
+///
+/// \brief Keep min, max and mean of the lux stream at several time scales.
+///
+/// \details
+///     The pyramid has four levels, with buckets of one second, one
+///     minute, one hour and one day. Each level has an open bucket,
+///     which accumulates the current period, and a small ring of the
+///     most recent closed buckets. Each sample is added to the open
+///     bucket of every level; when a period ends, its bucket is pushed
+///     into the ring. So an update takes O(levels) time, plus
+///     O(ring size) once per closed bucket.
+///
+///     Each level also keeps running summaries of its newest 1, 2, ...
+///     closed buckets, updated when a bucket is pushed. A range query
+///     ("the last 15 minutes") picks the finest level that covers the
+///     range, and combines the open bucket with one running summary,
+///     so it takes O(levels) time, without scanning any samples or
+///     buckets. The range is rounded up to whole buckets of that level.
+///
+///     Time is in seconds from any epoch, and must not go backwards;
+///     an RTC's time, or a counter of seconds since boot, is suitable.
+///     The pyramid takes about 7.5 kbytes of RAM.
+///
+class SummaryPyramid_t
+    {
+public:
+    /// \brief the levels of the pyramid.
+    enum class Level : std::uint8_t
+        {
+        Second,     ///< one-second buckets
+        Minute,     ///< one-minute buckets
+        Hour,       ///< one-hour buckets
+        Day,        ///< one-day buckets
+        nLevels     ///< number of levels; not a level.
+        };
+
+    /// \brief the number of levels.
+    static constexpr unsigned kLevels = unsigned(Level::nLevels);
+    /// \brief the number of closed one-second buckets kept.
+    static constexpr unsigned kSeconds = 60;
+    /// \brief the number of closed one-minute buckets kept.
+    static constexpr unsigned kMinutes = 60;
+    /// \brief the number of closed one-hour buckets kept.
+    static constexpr unsigned kHours = 24;
+    /// \brief the number of closed one-day buckets kept.
+    static constexpr unsigned kDays = 7;
+
+    /// \brief a summary of a set of samples.
+    struct Summary_t
+        {
+        float           min;            ///< smallest lux; 0 if count is zero.
+        float           max;            ///< largest lux; 0 if count is zero.
+        float           mean;           ///< mean lux; 0 if count is zero.
+        std::uint32_t   count;          ///< number of samples.
+        std::uint32_t   startSec;       ///< start of the period summarized.
+        };
+
+    SummaryPyramid_t()
+        {
+        this->reset();
+        }
+
+    // neither copyable nor movable
+    SummaryPyramid_t(const SummaryPyramid_t&) = delete;
+    SummaryPyramid_t& operator=(const SummaryPyramid_t&) = delete;
+    SummaryPyramid_t(const SummaryPyramid_t&&) = delete;
+    SummaryPyramid_t& operator=(const SummaryPyramid_t&&) = delete;
+
+    /// \brief forget everything.
+    void reset();
+
+    ///
+    /// \brief add a sample.
+    ///
+    /// \param [in] nowSec is the time of the sample, in seconds.
+    /// \param [in] lux is the light level.
+    ///
+    /// \return \c true for success, \c false if \p nowSec is earlier
+    ///     than the previous sample (the sample is ignored).
+    ///
+    bool update(std::uint32_t nowSec, float lux);
+
+    ///
+    /// \brief close the buckets of periods that have ended.
+    ///
+    /// \param [in] nowSec is the current time, in seconds.
+    ///
+    /// \details
+    ///     update() and query() do this; call it directly only to keep
+    ///     the rings current while no samples arrive.
+    ///
+    void advance(std::uint32_t nowSec);
+
+    ///
+    /// \brief summarize the samples of a recent period.
+    ///
+    /// \param [in] nowSec is the current time, in seconds.
+    /// \param [in] spanSec is the length of the period.
+    /// \param [out] result receives the summary; its \c startSec is the
+    ///     actual start of the period summarized, after rounding.
+    ///
+    /// \return \c true for success, \c false if \p spanSec is longer
+    ///     than the pyramid covers.
+    ///
+    bool query(std::uint32_t nowSec, std::uint32_t spanSec, Summary_t &result);
+
+    /// \brief summarize the last \p nMinutes minutes.
+    bool queryMinutes(std::uint32_t nowSec, std::uint32_t nMinutes, Summary_t &result)
+        {
+        return this->query(nowSec, nMinutes * 60, result);
+        }
+
+    ///
+    /// \brief return one bucket, e.g. to plot a level.
+    ///
+    /// \param [in] level is the level.
+    /// \param [in] age is 0 for the open bucket, 1 for the newest closed
+    ///     bucket, and so on.
+    /// \param [out] result receives the bucket's summary.
+    ///
+    /// \return \c true for success, \c false if there is no such bucket.
+    ///
+    bool getBucket(Level level, unsigned age, Summary_t &result) const;
+
+    /// \brief return the number of closed buckets kept at a level.
+    static constexpr unsigned getRingSize(Level level)
+        {
+        return level == Level::Second ? kSeconds :
+               level == Level::Minute ? kMinutes :
+               level == Level::Hour ? kHours :
+               level == Level::Day ? kDays : 0;
+        }
+
+    /// \brief return the length of a level's buckets, in seconds.
+    static constexpr std::uint32_t getBucketSeconds(Level level)
+        {
+        return level == Level::Second ? 1 :
+               level == Level::Minute ? 60 :
+               level == Level::Hour ? 60 * 60 :
+               level == Level::Day ? 24 * 60 * 60 : 0;
+        }
+
+private:
+    /// \brief accumulated samples
+    struct Bucket_t
+        {
+        float           min;            ///< smallest lux
+        float           max;            ///< largest lux
+        std::uint64_t   sum;            ///< sum of lux, in millilux
+        std::uint32_t   count;          ///< number of samples
+
+        /// \brief make the bucket empty.
+        void clear()
+            {
+            this->min = 0.0f;
+            this->max = 0.0f;
+            this->sum = 0;
+            this->count = 0;
+            }
+
+        /// \brief add one sample.
+        void add(float lux)
+            {
+            if (this->count == 0 || lux < this->min)
+                this->min = lux;
+            if (this->count == 0 || lux > this->max)
+                this->max = lux;
+            // an integer sum doesn't lose small samples as it grows.
+            if (lux > 0.0f)
+                this->sum += std::uint64_t(double(lux) * 1000.0 + 0.5);
+            ++this->count;
+            }
+
+        /// \brief add the samples of another bucket.
+        void merge(const Bucket_t &other)
+            {
+            if (other.count == 0)
+                return;
+            if (this->count == 0 || other.min < this->min)
+                this->min = other.min;
+            if (this->count == 0 || other.max > this->max)
+                this->max = other.max;
+            this->sum += other.sum;
+            this->count += other.count;
+            }
+        };
+
+    /// \brief one level of the pyramid
+    struct Level_t
+        {
+        Bucket_t        open;           ///< the current period
+        Bucket_t        *pRing;         ///< closed buckets, oldest overwritten
+        Bucket_t        *pRecent;       ///< pRecent[i] merges the newest i+1 closed buckets
+        std::uint32_t   index;          ///< bucket number of the open bucket
+        std::uint32_t   seconds;        ///< length of a bucket
+        std::uint16_t   size;           ///< number of closed buckets kept
+        std::uint16_t   head;           ///< ring index of the newest closed bucket
+        std::uint16_t   nClosed;        ///< number of valid closed buckets
+        };
+
+    /// \brief push the open bucket of a level, and start the next.
+    void close(Level_t &level);
+
+    /// \brief fill in a summary from a bucket.
+    static void toSummary(const Bucket_t &bucket, std::uint32_t startSec, Summary_t &result);
+
+    Level_t         m_level[kLevels];                   ///< the levels
+    Bucket_t        m_ring[kSeconds + kMinutes + kHours + kDays];   ///< storage for the rings
+    Bucket_t        m_recent[kSeconds + kMinutes + kHours + kDays]; ///< storage for the running summaries
+    std::uint32_t   m_lastSec;                          ///< time of the last update or advance
+    bool            m_fStarted;                         ///< true once time is known
+    };
+
+} // end namespace Mcci_Ltr_329als
+
+#endif /* _mcci_ltr_329als_pyramid_h_ */
@@ -0,0 +1,171 @@
+/*
+
+Module: mcci_ltr_329als_quantile.cpp
+
+Function:
+    Implementation code for the streaming quantile estimator.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "mcci_ltr_329als_quantile.h"
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+// protected
+float P2Quantile_t::desiredPosition(unsigned i) const
+    {
+    float const increment[kMarkers] =
+        { 0.0f, this->m_p / 2.0f, this->m_p, (1.0f + this->m_p) / 2.0f, 1.0f };
+
+    return (this->m_count - 1) * increment[i];
+    }
+
+/*
+
+Name:	P2Quantile_t::update()
+
+Function:
+    Add a sample to a P-squared quantile estimate.
+
+Definition:
+    void P2Quantile_t::update(
+        float x
+        );
+
+Description:
+    The first five samples are kept, sorted, as the initial marker
+    heights. After that, the cell containing x is found, the
+    extreme markers are updated if x is a new minimum or maximum,
+    and the positions of the markers above x are incremented. Each
+    of the three inner markers that is now at least one position
+    away from where it should be is moved one step toward its
+    desired position, and its height is adjusted with the P-squared
+    (piecewise-parabolic) formula, or linearly if the parabolic
+    estimate would not stay between its neighbours.
+
+Returns:
+    No explicit result.
+
+*/
+
+#define FUNCTION "P2Quantile_t::update"
+
+void
+P2Quantile_t::update(
+    float x
+    )
+    {
+    auto &q = this->m_height;
+    auto &n = this->m_position;
+
+    if (this->m_count < kMarkers)
+        {
+        // insertion sort into the initial markers.
+        unsigned i = this->m_count;
+        for (; i > 0 && q[i - 1] > x; --i)
+            q[i] = q[i - 1];
+        q[i] = x;
+
+        n[this->m_count] = this->m_count;
+        ++this->m_count;
+        return;
+        }
+
+    // find the cell k such that q[k] <= x < q[k+1].
+    unsigned k;
+    if (x < q[0])
+        {
+        q[0] = x;
+        k = 0;
+        }
+    else if (x >= q[kMarkers - 1])
+        {
+        q[kMarkers - 1] = x;
+        k = kMarkers - 2;
+        }
+    else
+        {
+        k = 0;
+        while (x >= q[k + 1])
+            ++k;
+        }
+
+    for (unsigned i = k + 1; i < kMarkers; ++i)
+        ++n[i];
+    ++this->m_count;
+
+    // adjust the inner markers.
+    for (unsigned i = 1; i < kMarkers - 1; ++i)
+        {
+        float const d = this->desiredPosition(i) - float(n[i]);
+
+        if ((d >= 1.0f && n[i + 1] - n[i] > 1) || (d <= -1.0f && n[i] - n[i - 1] > 1))
+            {
+            int const s = (d > 0.0f) ? 1 : -1;
+            float const fs = float(s);
+            float const nBelow = float(n[i] - n[i - 1]);
+            float const nAbove = float(n[i + 1] - n[i]);
+
+            // try the parabolic prediction.
+            float const qp = q[i] + fs / (nBelow + nAbove) *
+                                ((nBelow + fs) * (q[i + 1] - q[i]) / nAbove +
+                                 (nAbove - fs) * (q[i] - q[i - 1]) / nBelow);
+
+            if (q[i - 1] < qp && qp < q[i + 1])
+                q[i] = qp;
+            else
+                {
+                // fall back to linear.
+                unsigned const j = i + s;
+                q[i] += fs * (q[j] - q[i]) / (float(n[j]) - float(n[i]));
+                }
+
+            n[i] += s;
+            }
+        }
+    }
+
+#undef FUNCTION
+
+float P2Quantile_t::get() const
+    {
+    if (this->m_count == 0)
+        return 0.0f;
+
+    if (this->m_count <= kMarkers)
+        {
+        // exact: the samples are sorted in m_height, and the markers
+        // haven't moved yet; the middle one is the median, not p.
+        unsigned const i = unsigned(this->m_p * (this->m_count - 1) + 0.5f);
+        return this->m_height[i];
+        }
+
+    return this->m_height[2];
+    }
+
+float P2Quantile_t::getMin() const
+    {
+    return this->m_count == 0 ? 0.0f : this->m_height[0];
+    }
+
+float P2Quantile_t::getMax() const
+    {
+    if (this->m_count == 0)
+        return 0.0f;
+
+    return this->m_height[(this->m_count < kMarkers ? this->m_count : kMarkers) - 1];
+    }
+
+/**** end of mcci_ltr_329als_quantile.cpp ****/
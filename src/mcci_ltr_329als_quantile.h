@@ -0,0 +1,177 @@
+/*
+
+Module: mcci_ltr_329als_quantile.h
+
+Function:
+    Streaming quantile estimation for the MCCI LTR-329ALS library.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+/// \file
+
+#ifndef _mcci_ltr_329als_quantile_h_
+#define _mcci_ltr_329als_quantile_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <cstdint>
+
+namespace Mcci_Ltr_329als {
+
+///
+/// \brief Estimate one quantile of a stream with the P-squared algorithm.
+///
+/// \details
+///     The P-squared algorithm (Jain and Chlamtac, 1985) keeps five
+///     markers: the minimum, the maximum, the target quantile and two
+///     quantiles halfway to the extremes. Each sample moves the
+///     markers by at most one position, adjusting their heights with
+///     a piecewise-parabolic fit. Update is O(1), and the state is 48
+///     bytes however many samples are seen.
+///
+///     Until five samples have been seen, the result is exact.
+///
+class P2Quantile_t
+    {
+public:
+    /// \brief the number of markers.
+    static constexpr unsigned kMarkers = 5;
+
+    ///
+    /// \brief construct an estimator.
+    ///
+    /// \param [in] p is the quantile to estimate, in (0, 1); e.g. 0.5
+    ///     for the median.
+    ///
+    P2Quantile_t(float p = 0.5f)
+        : m_p(p)
+        {
+        this->reset();
+        }
+
+    /// \brief forget all samples.
+    void reset()
+        {
+        this->m_count = 0;
+        }
+
+    /// \brief change the quantile, and forget all samples.
+    void setQuantile(float p)
+        {
+        this->m_p = p;
+        this->reset();
+        }
+
+    /// \brief return the quantile being estimated.
+    float getQuantile() const
+        {
+        return this->m_p;
+        }
+
+    /// \brief add a sample.
+    void update(float x);
+
+    /// \brief return the number of samples seen.
+    std::uint32_t getCount() const
+        {
+        return this->m_count;
+        }
+
+    ///
+    /// \brief return the current estimate.
+    ///
+    /// \return the estimated quantile, or zero if no samples have been seen.
+    ///     Up to five samples, it is the nearest order statistic for p.
+    ///
+    float get() const;
+
+    /// \brief return the smallest sample seen.
+    float getMin() const;
+
+    /// \brief return the largest sample seen.
+    float getMax() const;
+
+protected:
+    /// \brief return the desired position of marker \p i (0-based positions).
+    float desiredPosition(unsigned i) const;
+
+private:
+    float           m_height[kMarkers];     ///< marker heights
+    std::uint32_t   m_position[kMarkers];   ///< marker positions (0-based)
+    std::uint32_t   m_count;                ///< number of samples
+    float           m_p;                    ///< quantile to estimate
+    };
+
+///
+/// \brief Track the 10th, 50th and 90th percentiles of lux.
+///
+/// \details
+///     This is the set of statistics needed for a typical lighting
+///     compliance report; feed it every sample (or every usable
+///     sample, see SampleQuality_t::isUsable()) and read the
+///     percentiles at the end of the reporting period.
+///
+class LuxPercentiles_t
+    {
+public:
+    LuxPercentiles_t()
+        : m_p10(0.10f)
+        , m_p50(0.50f)
+        , m_p90(0.90f)
+        {}
+
+    /// \brief forget all samples.
+    void reset()
+        {
+        this->m_p10.reset();
+        this->m_p50.reset();
+        this->m_p90.reset();
+        }
+
+    /// \brief add a sample.
+    void update(float lux)
+        {
+        this->m_p10.update(lux);
+        this->m_p50.update(lux);
+        this->m_p90.update(lux);
+        }
+
+    /// \brief return the number of samples seen.
+    std::uint32_t getCount() const
+        {
+        return this->m_p50.getCount();
+        }
+
+    /// \brief return the estimated 10th percentile.
+    float getP10() const
+        {
+        return this->m_p10.get();
+        }
+
+    /// \brief return the estimated median.
+    float getMedian() const
+        {
+        return this->m_p50.get();
+        }
+
+    /// \brief return the estimated 90th percentile.
+    float getP90() const
+        {
+        return this->m_p90.get();
+        }
+
+private:
+    P2Quantile_t    m_p10;      ///< 10th percentile
+    P2Quantile_t    m_p50;      ///< median
+    P2Quantile_t    m_p90;      ///< 90th percentile
+    };
+
+} // end namespace Mcci_Ltr_329als
+
+#endif /* _mcci_ltr_329als_quantile_h_ */
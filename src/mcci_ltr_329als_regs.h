@@ -84,6 +84,7 @@ namespace Mcci_Ltr_329als_Regs {
         enum class ALS_STATUS_BITS : std::uint8_t
             {
             NEW = 1 << 2,                       ///< new data if true
+            INTR = 1 << 3,                      ///< interrupt asserted (LTR-303ALS only)
             GAIN = 7 << 4,                      ///< Data gain range
             INVALID = 1 << 7,                   ///< invalid data if true
             };
@@ -107,6 +108,9 @@ namespace Mcci_Ltr_329als_Regs {
             return 10;
             }
 
+        /// \brief the value of \c ALS_MEAS_RATE after reset (100 ms, 500 ms).
+        static constexpr std::uint8_t kMeasRateResetValue = 0x03;
+
         static constexpr std::uint32_t getMaxInitialDelayMs()
             {
             // data sheet says 1000, but that's at 25c and 3.0V.  Allow some margin.
@@ -159,6 +163,45 @@ namespace Mcci_Ltr_329als_Regs {
             };
         };
 
+    ///
+    /// \brief Constants for the interrupt-capable LTR-303ALS.
+    ///
+    /// \details
+    ///     The LTR-303ALS has the same I2C address and register map as
+    ///     the LTR-329ALS (including \c PART_ID and \c MANUFAC_ID
+    ///     values, so the two can't be told apart by probing). It adds
+    ///     threshold and interrupt registers, and an \c INT pin. This
+    ///     class adds those to the LTR-329ALS constants.
+    ///
+    class LTR_303ALS_PARAMS : public LTR_329ALS_PARAMS
+        {
+    public:
+        /// \brief additional register addresses within the LTR-303ALS.
+        enum class IntReg_t : std::uint8_t
+            {
+            INTERRUPT           = 0x8F,         ///< interrupt settings
+            ALS_THRES_UP_0      = 0x97,         ///< upper threshold, LSB
+            ALS_THRES_UP_1      = 0x98,         ///< upper threshold, MSB
+            ALS_THRES_LOW_0     = 0x99,         ///< lower threshold, LSB
+            ALS_THRES_LOW_1     = 0x9A,         ///< lower threshold, MSB
+            INTERRUPT_PERSIST   = 0x9E,         ///< interrupt persistence
+            };
+
+        /// \brief bits in the LTR-303ALS \c INTERRUPT register
+        enum class INTERRUPT_BITS : std::uint8_t
+            {
+            MODE = 1 << 1,                      ///< interrupt enabled if set
+            POLARITY = 1 << 2,                  ///< \c INT active high if set, active low otherwise
+            RESERVED = 1 << 3,                  ///< reserved; set at reset, write as 1
+            };
+
+        /// \brief bits in the LTR-303ALS \c INTERRUPT_PERSIST register
+        enum class INTERRUPT_PERSIST_BITS : std::uint8_t
+            {
+            ALS_PERSIST = 0xF << 0,             ///< consecutive out-of-range values before interrupt, minus one
+            };
+        };
+
 	///
     /// \brief Common abstract class for LTR-329ALS gains and gain codes.
 	///
@@ -621,6 +664,16 @@ namespace Mcci_Ltr_329als_Regs {
             return *this;
             }
 
+        ///
+        /// \brief get the interrupt status bit from a register image.
+        ///
+        /// \note this bit is only implemented by the LTR-303ALS.
+        ///
+        bool getInterrupt() const
+            {
+            return this->m_value & std::uint8_t(ALS_STATUS_BITS::INTR);
+            }
+
         ///
         /// \brief get the data valid bit from a register image.
         ///
@@ -632,6 +685,170 @@ namespace Mcci_Ltr_329als_Regs {
             }
         };
 
+    ///
+    /// \brief Compact quality flags for a measurement.
+    ///
+    /// \details
+    ///     The driver computes these when it reads each sample, and
+    ///     stores them in the DataRegs_t, so that filters and aggregators
+    ///     can drop or down-weight poor samples without looking at the
+    ///     raw counts again. The value fits in 16 bits:
+    ///
+    ///     - saturation: a channel at full scale, or within 1/16 of it;
+    ///     - the ratio region used by DataRegs_t::luxComputation();
+    ///     - gain mismatch: the data gain in \c ALS_STATUS differs from
+    ///       the gain written to \c ALS_CONTR (the sample was taken
+    ///       before a gain change took effect);
+    ///     - data marked invalid by the sensor;
+    ///     - an estimate of SNR from counting statistics, in quarter dB.
+    ///
+    class SampleQuality_t : public LTR_329ALS_PARAMS::Field_t<std::uint16_t>
+        {
+    public:
+        /// \brief the ratio regions of the lux formula, by ch1 / (ch0 + ch1).
+        enum class Region : std::uint8_t
+            {
+            Low,        ///< ratio below DataRegs_t::kLuxRatio1
+            Mid,        ///< ratio below DataRegs_t::kLuxRatio2
+            High,       ///< ratio below DataRegs_t::kLuxRatio3
+            Out,        ///< ratio above the formula's range; lux is zero
+            };
+
+        /// \brief bits in the quality value
+        enum class Bits : std::uint16_t
+            {
+            SATURATED       = 1 << 0,       ///< a channel is at full scale
+            NEAR_SATURATED  = 1 << 1,       ///< a channel is within 1/16 of full scale
+            REGION          = 3 << 2,       ///< ratio region
+            GAIN_MISMATCH   = 1 << 4,       ///< data gain differs from requested gain
+            INVALID         = 1 << 5,       ///< sensor marked the data invalid
+            SNR             = 0xFF << 8,    ///< SNR estimate, in units of 0.25 dB
+            };
+
+        /// \brief counts at or above this are near saturation.
+        static constexpr std::uint16_t kNearSaturation = 0xF000;
+
+        SampleQuality_t() = default;
+
+        SampleQuality_t(std::uint16_t value)
+            : m_value(value)
+            {}
+
+        /// \brief return the value as a std::uint16_t.
+        std::uint16_t getValue() const
+            {
+            return this->m_value;
+            }
+
+        /// \brief return \c true if either channel is at full scale.
+        bool getSaturated() const
+            {
+            return this->m_value & std::uint16_t(Bits::SATURATED);
+            }
+
+        /// \brief return \c true if either channel is at or near full scale.
+        bool getNearSaturated() const
+            {
+            return this->m_value & std::uint16_t(Bits::NEAR_SATURATED);
+            }
+
+        /// \brief return the ratio region used for the lux computation.
+        Region getRegion() const
+            {
+            return Region(fieldget(std::uint16_t(Bits::REGION), this->m_value));
+            }
+
+        /// \brief return \c true if the data gain differs from the requested gain.
+        bool getGainMismatch() const
+            {
+            return this->m_value & std::uint16_t(Bits::GAIN_MISMATCH);
+            }
+
+        /// \brief return \c true if the sensor marked the data invalid.
+        bool getInvalid() const
+            {
+            return this->m_value & std::uint16_t(Bits::INVALID);
+            }
+
+        /// \brief return the SNR estimate, in units of 0.25 dB.
+        std::uint8_t getSnrQuarterDb() const
+            {
+            return std::uint8_t(fieldget(std::uint16_t(Bits::SNR), this->m_value));
+            }
+
+        ///
+        /// \brief return \c true if the sample can be converted to lux
+        ///     without qualification.
+        ///
+        /// \details
+        ///     That is, it is valid, not saturated, taken at the requested
+        ///     gain, and within the range of the lux formula.
+        ///
+        bool isUsable() const
+            {
+            return (this->m_value & std::uint16_t(
+                        std::uint16_t(Bits::SATURATED) |
+                        std::uint16_t(Bits::GAIN_MISMATCH) |
+                        std::uint16_t(Bits::INVALID)
+                        )) == 0 &&
+                   this->getRegion() != Region::Out;
+            }
+
+        ///
+        /// \brief estimate SNR from a count, in quarter dB.
+        ///
+        /// \param [in] n is the total number of counts.
+        ///
+        /// \details
+        ///     With Poisson statistics, SNR is \f$\sqrt{n}\f$, or
+        ///     \f$10 \log_{10} n\f$ dB. The logarithm is approximated in
+        ///     fixed point (interpolating linearly between powers of two),
+        ///     which is within 0.3 dB.
+        ///
+        static constexpr std::uint8_t snrQuarterDb(std::uint32_t n)
+            {
+            if (n == 0)
+                return 0;
+
+            unsigned msb = 0;
+            for (std::uint32_t v = n; v > 1; v >>= 1)
+                ++msb;
+
+            // log2(n) in Q8.
+            std::uint32_t const frac = (msb >= 8) ? (n >> (msb - 8)) & 0xFF
+                                                  : (n << (8 - msb)) & 0xFF;
+            std::uint32_t const log2q8 = (msb << 8) | frac;
+
+            // 40 * log10(n) = 12.041 * log2(n); 12.041 ~= 3083 / 256.
+            std::uint32_t const result = (log2q8 * 3083 + 32768) >> 16;
+            return std::uint8_t(result > 0xFF ? 0xFF : result);
+            }
+
+        /// \brief build a quality value from its parts.
+        static SampleQuality_t make(
+            bool fSaturated,
+            bool fNearSaturated,
+            Region region,
+            bool fGainMismatch,
+            bool fInvalid,
+            std::uint8_t snrQuarterDb
+            )
+            {
+            std::uint16_t v = 0;
+
+            v = fieldset(std::uint16_t(Bits::SATURATED), v, fSaturated);
+            v = fieldset(std::uint16_t(Bits::NEAR_SATURATED), v, fNearSaturated);
+            v = fieldset(std::uint16_t(Bits::REGION), v, std::uint16_t(region));
+            v = fieldset(std::uint16_t(Bits::GAIN_MISMATCH), v, fGainMismatch);
+            v = fieldset(std::uint16_t(Bits::INVALID), v, fInvalid);
+            v = fieldset(std::uint16_t(Bits::SNR), v, snrQuarterDb);
+            return SampleQuality_t(v);
+            }
+
+    private:
+        std::uint16_t m_value = 0;
+        };
+
     ///
     /// \brief Simple class for LTR-329ALS data registers.
     ///
@@ -649,6 +866,7 @@ namespace Mcci_Ltr_329als_Regs {
         std::uint8_t m_data[4] = {};
         AlsStatus_t m_status = 0;       ///< recorded status register when data was grabbed.
         AlsMeasRate_t m_measrate = 0;   ///< recorded measrate used for grabbing the data
+        SampleQuality_t m_quality = 0;  ///< quality flags computed when the data was grabbed
 
 
     public:
@@ -674,6 +892,7 @@ namespace Mcci_Ltr_329als_Regs {
             this->m_data[2] = 0;
             this->m_data[3] = 0;
             this->m_status = AlsStatus_t(0).setValid(false).setNew(false);
+            this->m_quality = SampleQuality_t(0);
             }
 
         /// \brief return a pointer to the base of the data buffer
@@ -700,6 +919,48 @@ namespace Mcci_Ltr_329als_Regs {
             this->m_measrate = measRate;
             }
 
+        /// \brief return the saved image of the status register
+        AlsStatus_t getStatus() const
+            {
+            return this->m_status;
+            }
+
+        /// \brief return the saved image of the meas/rate register
+        AlsMeasRate_t getMeasRate() const
+            {
+            return this->m_measrate;
+            }
+
+        /// \brief return the quality flags of this measurement
+        SampleQuality_t getQuality() const
+            {
+            return this->m_quality;
+            }
+
+        ///
+        /// \brief compute and save the quality flags of this measurement.
+        ///
+        /// \param [in] requestedGain is the gain that was written to
+        ///     \c ALS_CONTR for this measurement.
+        ///
+        /// \details
+        ///     Call this after the data and status have been saved.
+        ///
+        void updateQuality(AlsGain_t::Gain_t requestedGain)
+            {
+            auto const ch0 = this->getChan0();
+            auto const ch1 = this->getChan1();
+
+            this->m_quality = SampleQuality_t::make(
+                                this->isSaturated(),
+                                ch0 >= SampleQuality_t::kNearSaturation || ch1 >= SampleQuality_t::kNearSaturation,
+                                getLuxRegion(ch0, ch1),
+                                this->m_status.getGain() != requestedGain,
+                                ! this->m_status.getValid(),
+                                SampleQuality_t::snrQuarterDb(this->getTotalCounts())
+                                );
+            }
+
         /// \brief get the integration time previously saved
         AlsMeasRate_t::Integration_t getIntegrationTime() const
             {
@@ -712,6 +973,69 @@ namespace Mcci_Ltr_329als_Regs {
             return this->m_status.getGain();
             }
 
+        /// \brief the largest value a data channel can report.
+        static constexpr std::uint16_t kMaxCount = 0xFFFF;
+
+        /// \brief return \c true if either channel is at full scale.
+        bool isSaturated() const
+            {
+            return this->getChan0() >= kMaxCount || this->getChan1() >= kMaxCount;
+            }
+
+        /// \brief return the total counts of both channels.
+        std::uint32_t getTotalCounts() const
+            {
+            return std::uint32_t(this->getChan0()) + this->getChan1();
+            }
+
+        /// \name Lux coefficients
+        /// \brief The piecewise-linear lux formula of appendix A of the datasheet.
+        ///
+        /// \details
+        ///     For ratio = ch1 / (ch0 + ch1) below \c kLuxRatio<i>N</i>, the
+        ///     raw lux is <tt>kLuxCh0Coeff<i>N</i> * ch0 + kLuxCh1Coeff<i>N</i> * ch1</tt>.
+        ///     These are shared with bulk converters, so that they give the
+        ///     same answers as luxComputation(). The second and third ratio
+        ///     limits are \c double, as they have always been; the float
+        ///     ratio is compared in double precision, which puts the
+        ///     boundaries in slightly different places than \c 0.64f and
+        ///     \c 0.85f would.
+        ///
+        /// @{
+        static constexpr float kLuxRatio1 = 0.45f;
+        static constexpr float kLuxCh0Coeff1 = 1.7743f;
+        static constexpr float kLuxCh1Coeff1 = 1.1059f;
+        static constexpr double kLuxRatio2 = 0.64;
+        static constexpr float kLuxCh0Coeff2 = 4.2785f;
+        static constexpr float kLuxCh1Coeff2 = -1.9548f;
+        static constexpr double kLuxRatio3 = 0.85;
+        static constexpr float kLuxCh0Coeff3 = 0.5926f;
+        static constexpr float kLuxCh1Coeff3 = 0.1185f;
+        /// @}
+
+        ///
+        /// \brief return the ratio region of the lux formula for a measurement.
+        ///
+        /// \param [in] ch0 is the measurement for channel 0
+        /// \param [in] ch1 is the measurement for channel 1
+        ///
+        /// \return the region; if both channels are zero, Region::Low.
+        ///
+        static constexpr SampleQuality_t::Region getLuxRegion(
+            std::uint16_t ch0,
+            std::uint16_t ch1
+            )
+            {
+            float const ch01_sum = float(ch0) + float(ch1);
+            float const ratio = (ch01_sum == 0.0f) ? 0.0f : ch1 / ch01_sum;
+
+            return  (ratio < kLuxRatio1) ? SampleQuality_t::Region::Low
+                :   (ratio < kLuxRatio2) ? SampleQuality_t::Region::Mid
+                :   (ratio < kLuxRatio3) ? SampleQuality_t::Region::High
+                :                          SampleQuality_t::Region::Out
+                ;
+            }
+
         ///
         /// \brief Compute abstract value of lux based on datasheet
         ///
@@ -729,16 +1053,15 @@ namespace Mcci_Ltr_329als_Regs {
             std::uint32_t iTime
             )
             {
-            float const ch01_sum = ch0 + ch1;
-            if (ch01_sum == 0.0f)
+            if (ch0 + ch1 == 0)
                 return 0.0f;
 
-            float const ratio = ch1 / ch01_sum;
+            auto const region = getLuxRegion(ch0, ch1);
 
-            float result = (ratio < 0.45f) ? (1.7743f * ch0 + 1.1059f * ch1)
-                         : (ratio < 0.64)  ? (4.2785f * ch0 - 1.9548f * ch1)
-                         : (ratio < 0.85)  ? (0.5926f * ch0 + 0.1185f * ch1)
-                         :                   0.0f
+            float result = (region == SampleQuality_t::Region::Low)  ? (kLuxCh0Coeff1 * ch0 + kLuxCh1Coeff1 * ch1)
+                         : (region == SampleQuality_t::Region::Mid)  ? (kLuxCh0Coeff2 * ch0 + kLuxCh1Coeff2 * ch1)
+                         : (region == SampleQuality_t::Region::High) ? (kLuxCh0Coeff3 * ch0 + kLuxCh1Coeff3 * ch1)
+                         :                                             0.0f
                          ;
 
             return (result * 100.0f) / (gain * iTime);
@@ -0,0 +1,445 @@
+/*
+
+Module: mcci_ltr_329als_store.cpp
+
+Function:
+    Implementation code for the append-only sample store.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "mcci_ltr_329als_store.h"
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Manifest constants & typedefs.
+|
+\****************************************************************************/
+
+static void putUint32(std::uint8_t *p, std::uint32_t v);
+static std::uint32_t getUint32(const std::uint8_t *p);
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+std::uint8_t SampleStore_t::crc8(const std::uint8_t *p, std::size_t n)
+    {
+    std::uint8_t crc = 0;
+
+    // CRC-8, polynomial x^8 + x^2 + x + 1.
+    for (; n > 0; --n)
+        {
+        crc ^= *p++;
+        for (unsigned i = 0; i < 8; ++i)
+            crc = (crc & 0x80) ? std::uint8_t((crc << 1) ^ 0x07) : std::uint8_t(crc << 1);
+        }
+
+    return crc;
+    }
+
+/*
+
+Name:	SampleStore_t::mount()
+
+Function:
+    Scan the backend and build the sparse time index.
+
+Definition:
+    bool SampleStore_t::mount(
+        void
+        );
+
+Description:
+    The header of every segment is read, to find the oldest and
+    newest segments. The append position in the newest segment is
+    found by binary search (erased slots form a suffix), and the
+    first timestamp of each segment is recorded in the index. If
+    no segment has a valid header, the backend is formatted.
+
+Returns:
+    true for success, false for failure.
+
+Notes:
+    Only the headers, the first record of each segment and O(log n)
+    slots of the newest segment are read.
+
+*/
+
+#define FUNCTION "SampleStore_t::mount"
+
+bool
+SampleStore_t::mount(
+    void
+    )
+    {
+    this->m_fMounted = false;
+
+    std::uint32_t const segmentSize = this->m_backend.getSegmentSize();
+    if (segmentSize < kHeaderSize + kRecordSize)
+        return false;
+
+    std::uint32_t const nSegments = this->m_backend.getSize() / segmentSize;
+    if (nSegments < 2 || nSegments > kMaxSegments)
+        return false;
+
+    std::uint32_t const nRecords = (segmentSize - kHeaderSize) / kRecordSize;
+    if (nRecords > 0xFFFFu)
+        return false;
+
+    this->m_segmentSize = segmentSize;
+    this->m_nSegments = std::uint8_t(nSegments);
+    this->m_recordsPerSegment = std::uint16_t(nRecords);
+
+    // read the headers.
+    bool fFound = false;
+    std::uint32_t minSequence = 0;
+    bool fValid[kMaxSegments];
+
+    for (unsigned i = 0; i < nSegments; ++i)
+        {
+        std::uint8_t header[kHeaderSize];
+
+        if (! this->m_backend.read(i * segmentSize, header, sizeof(header)))
+            return false;
+
+        fValid[i] = getUint32(header) == kMagic && header[kHeaderSize - 1] == kCommit;
+        this->m_index[i].sequence = getUint32(header + 4);
+        this->m_index[i].fHasRecord = false;
+
+        if (fValid[i] && (! fFound || this->m_index[i].sequence < minSequence))
+            {
+            fFound = true;
+            minSequence = this->m_index[i].sequence;
+            this->m_oldest = std::uint8_t(i);
+            }
+        }
+
+    if (! fFound)
+        return this->format();
+
+    // the segments in use run in sequence from the oldest.
+    this->m_nUsed = 0;
+    for (unsigned l = 0; l < nSegments; ++l)
+        {
+        auto const p = this->physical(l);
+        if (! fValid[p] || this->m_index[p].sequence != minSequence + l)
+            break;
+        ++this->m_nUsed;
+        }
+
+    // find the append position in the newest segment.
+    auto const newest = this->physical(this->m_nUsed - 1);
+    std::uint16_t lo = 0;
+    std::uint16_t hi = this->m_recordsPerSegment;
+
+    while (lo < hi)
+        {
+        std::uint16_t const mid = lo + (hi - lo) / 2;
+
+        if (this->isSlotErased(newest, mid))
+            hi = mid;
+        else
+            lo = mid + 1;
+        }
+    this->m_writeSlot = lo;
+
+    // build the sparse index, and find the newest timestamp.
+    std::uint32_t carry = 0;
+    this->m_lastTimestamp = 0;
+    for (unsigned l = 0; l < this->m_nUsed; ++l)
+        {
+        auto const p = this->physical(l);
+        auto const count = this->slotsInUse(l);
+        Record_t record;
+        auto &entry = this->m_index[p];
+
+        entry.fHasRecord = this->findValid(p, 0, count, record) < count;
+        if (entry.fHasRecord)
+            carry = record.timestamp;
+        // segments without records inherit the previous key, keeping the index sorted.
+        entry.firstTimestamp = carry;
+
+        for (auto slot = count; entry.fHasRecord && slot > 0; --slot)
+            {
+            if (this->readRecord(p, slot - 1, record))
+                {
+                this->m_lastTimestamp = record.timestamp;
+                break;
+                }
+            }
+        }
+
+    this->m_fMounted = true;
+    return true;
+    }
+
+#undef FUNCTION
+
+bool SampleStore_t::format()
+    {
+    this->m_fMounted = false;
+
+    if (this->m_nSegments == 0)
+        {
+        // called before geometry is known; mount() will call us back.
+        return this->mount();
+        }
+
+    for (unsigned i = 0; i < this->m_nSegments; ++i)
+        {
+        if (! this->m_backend.erase(i * this->m_segmentSize))
+            return false;
+        }
+
+    if (! this->startSegment(0, 0))
+        return false;
+
+    this->m_oldest = 0;
+    this->m_nUsed = 1;
+    this->m_writeSlot = 0;
+    this->m_lastTimestamp = 0;
+    this->m_fMounted = true;
+    return true;
+    }
+
+bool SampleStore_t::append(std::uint32_t timestamp, const DataRegs_t &sample)
+    {
+    if (! this->m_fMounted)
+        return false;
+
+    bool const fEmpty = this->m_nUsed == 1 && ! this->m_index[this->m_oldest].fHasRecord;
+    if (! fEmpty && timestamp < this->m_lastTimestamp)
+        return false;
+
+    // move to a new segment if the current one is full.
+    if (this->m_writeSlot >= this->m_recordsPerSegment)
+        {
+        auto const newest = this->physical(this->m_nUsed - 1);
+        auto const next = (newest + 1) % this->m_nSegments;
+        auto const sequence = this->m_index[newest].sequence + 1;
+
+        if (this->m_nUsed == this->m_nSegments)
+            {
+            // discard the oldest segment.
+            this->m_oldest = std::uint8_t((this->m_oldest + 1) % this->m_nSegments);
+            --this->m_nUsed;
+            }
+
+        if (! this->startSegment(next, sequence))
+            return false;
+
+        this->m_index[next].firstTimestamp = timestamp;
+        ++this->m_nUsed;
+        this->m_writeSlot = 0;
+        }
+
+    auto const phys = this->physical(this->m_nUsed - 1);
+    auto const slot = this->m_writeSlot++;
+    std::uint8_t buffer[kRecordSize];
+    DataRegs_t regs = sample;
+
+    putUint32(buffer, timestamp);
+    std::memcpy(buffer + 4, regs.getDataPointer(), 4);
+    buffer[8] = regs.getStatus().getValue();
+    buffer[9] = regs.getMeasRate().getValue();
+    buffer[10] = crc8(buffer, 10);
+    buffer[11] = kCommit;
+
+    // write the body, then the commit marker.
+    auto const offset = this->slotOffset(phys, slot);
+    if (! this->m_backend.write(offset, buffer, kRecordSize - 1))
+        return false;
+    if (! this->m_backend.write(offset + kRecordSize - 1, buffer + kRecordSize - 1, 1))
+        return false;
+
+    auto &entry = this->m_index[phys];
+    if (! entry.fHasRecord)
+        {
+        entry.fHasRecord = true;
+        entry.firstTimestamp = timestamp;
+        }
+
+    this->m_lastTimestamp = timestamp;
+    return true;
+    }
+
+bool SampleStore_t::seek(std::uint32_t timestamp, Cursor_t &cursor)
+    {
+    this->rewind(cursor);
+    if (! this->m_fMounted)
+        return false;
+
+    // find the last segment whose first timestamp is <= timestamp.
+    unsigned lo = 0;
+    unsigned hi = this->m_nUsed;
+
+    while (lo < hi)
+        {
+        unsigned const mid = lo + (hi - lo) / 2;
+        auto const &entry = this->m_index[this->physical(mid)];
+        bool const fAfter = (mid + 1 == this->m_nUsed && ! entry.fHasRecord) ||
+                            entry.firstTimestamp > timestamp;
+
+        if (fAfter)
+            hi = mid;
+        else
+            lo = mid + 1;
+        }
+
+    if (lo == 0)
+        // everything is at or after timestamp.
+        return this->m_index[this->physical(0)].fHasRecord || this->m_nUsed > 1;
+
+    // search within the segment for the first record >= timestamp.
+    unsigned const logical = lo - 1;
+    auto const phys = this->physical(logical);
+    auto const count = this->slotsInUse(logical);
+    std::uint16_t slotLo = 0;
+    std::uint16_t slotHi = count;
+
+    while (slotLo < slotHi)
+        {
+        std::uint16_t const mid = slotLo + (slotHi - slotLo) / 2;
+        Record_t record;
+        auto const found = this->findValid(phys, mid, slotHi, record);
+
+        if (found == slotHi || record.timestamp >= timestamp)
+            slotHi = mid;
+        else
+            slotLo = found + 1;
+        }
+
+    cursor.segment = std::uint8_t(logical);
+    cursor.slot = slotLo;
+    if (slotLo >= count)
+        {
+        cursor.segment = std::uint8_t(logical + 1);
+        cursor.slot = 0;
+        }
+
+    return cursor.segment < this->m_nUsed &&
+           cursor.slot < this->slotsInUse(cursor.segment);
+    }
+
+bool SampleStore_t::next(Cursor_t &cursor, Record_t &record)
+    {
+    if (! this->m_fMounted)
+        return false;
+
+    while (cursor.segment < this->m_nUsed)
+        {
+        if (cursor.slot >= this->slotsInUse(cursor.segment))
+            {
+            ++cursor.segment;
+            cursor.slot = 0;
+            continue;
+            }
+
+        auto const slot = cursor.slot++;
+        if (this->readRecord(this->physical(cursor.segment), slot, record))
+            return true;
+        }
+
+    return false;
+    }
+
+// protected
+bool SampleStore_t::readRecord(unsigned physSegment, unsigned slot, Record_t &record)
+    {
+    std::uint8_t buffer[kRecordSize];
+
+    if (! this->m_backend.read(this->slotOffset(physSegment, slot), buffer, sizeof(buffer)))
+        return false;
+
+    if (buffer[kRecordSize - 1] != kCommit || buffer[10] != crc8(buffer, 10))
+        return false;
+
+    record.timestamp = getUint32(buffer);
+    std::memcpy(record.data, buffer + 4, sizeof(record.data));
+    record.status = AlsStatus_t(buffer[8]);
+    record.measrate = AlsMeasRate_t(buffer[9]);
+    return true;
+    }
+
+// protected
+bool SampleStore_t::isSlotErased(unsigned physSegment, unsigned slot)
+    {
+    std::uint8_t buffer[kRecordSize];
+
+    if (! this->m_backend.read(this->slotOffset(physSegment, slot), buffer, sizeof(buffer)))
+        return false;
+
+    for (auto const b : buffer)
+        {
+        if (b != 0xFF)
+            return false;
+        }
+
+    return true;
+    }
+
+// protected
+std::uint16_t SampleStore_t::findValid(unsigned physSegment, std::uint16_t slot, std::uint16_t count, Record_t &record)
+    {
+    for (; slot < count; ++slot)
+        {
+        if (this->readRecord(physSegment, slot, record))
+            break;
+        }
+
+    return slot;
+    }
+
+// protected
+bool SampleStore_t::startSegment(unsigned physSegment, std::uint32_t sequence)
+    {
+    std::uint8_t header[kHeaderSize];
+    auto const offset = physSegment * this->m_segmentSize;
+
+    if (! this->m_backend.erase(offset))
+        return false;
+
+    std::memset(header, 0xFF, sizeof(header));
+    putUint32(header, kMagic);
+    putUint32(header + 4, sequence);
+
+    // write the header, then the commit marker.
+    if (! this->m_backend.write(offset, header, kHeaderSize - 1))
+        return false;
+
+    header[kHeaderSize - 1] = kCommit;
+    if (! this->m_backend.write(offset + kHeaderSize - 1, header + kHeaderSize - 1, 1))
+        return false;
+
+    auto &entry = this->m_index[physSegment];
+    entry.sequence = sequence;
+    entry.fHasRecord = false;
+    entry.firstTimestamp = this->m_lastTimestamp;
+    return true;
+    }
+
+static void putUint32(std::uint8_t *p, std::uint32_t v)
+    {
+    p[0] = std::uint8_t(v);
+    p[1] = std::uint8_t(v >> 8);
+    p[2] = std::uint8_t(v >> 16);
+    p[3] = std::uint8_t(v >> 24);
+    }
+
+static std::uint32_t getUint32(const std::uint8_t *p)
+    {
+    return std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8) |
+           (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+    }
+
+/**** end of mcci_ltr_329als_store.cpp ****/
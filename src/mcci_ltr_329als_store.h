@@ -0,0 +1,331 @@
+/*
+
+Module: mcci_ltr_329als_store.h
+
+Function:
+    Append-only sample store for the MCCI LTR-329ALS library.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+/// \file
+
+#ifndef _mcci_ltr_329als_store_h_
+#define _mcci_ltr_329als_store_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include "mcci_ltr_329als_regs.h"
+
+namespace Mcci_Ltr_329als {
+
+using namespace Mcci_Ltr_329als_Regs;
+
+///
+/// \brief Abstract byte-addressable storage for a SampleStore_t.
+///
+/// \details
+///     The storage is divided into equal segments, each of which can
+///     be erased (set to 0xFF) as a unit. Writes only ever program
+///     erased bytes, so the same layout works for FRAM and NOR flash.
+///     The library supplies SampleStoreMemoryBackend_t; other storage
+///     needs a backend of its own.
+///
+class SampleStoreBackend_t
+    {
+public:
+    virtual ~SampleStoreBackend_t() = default;
+
+    /// \brief return the total size of the storage, in bytes.
+    virtual std::uint32_t getSize() const = 0;
+
+    /// \brief return the size of an erasable segment, in bytes.
+    virtual std::uint32_t getSegmentSize() const = 0;
+
+    /// \brief read \p n bytes at \p offset.
+    virtual bool read(std::uint32_t offset, void *pBuffer, std::size_t n) = 0;
+
+    /// \brief write \p n bytes at \p offset (which must be erased).
+    virtual bool write(std::uint32_t offset, const void *pBuffer, std::size_t n) = 0;
+
+    /// \brief erase the segment starting at \p offset.
+    virtual bool erase(std::uint32_t offset) = 0;
+    };
+
+///
+/// \brief A SampleStoreBackend_t in RAM, or in memory-mapped FRAM.
+///
+class SampleStoreMemoryBackend_t : public SampleStoreBackend_t
+    {
+public:
+    ///
+    /// \brief construct a backend over a buffer.
+    ///
+    /// \param [in] pBuffer points to the storage.
+    /// \param [in] nBuffer is the size of the storage.
+    /// \param [in] segmentSize is the size of each segment.
+    ///
+    SampleStoreMemoryBackend_t(std::uint8_t *pBuffer, std::uint32_t nBuffer, std::uint32_t segmentSize)
+        : m_pBuffer(pBuffer)
+        , m_nBuffer(nBuffer)
+        , m_segmentSize(segmentSize)
+        {}
+
+    virtual std::uint32_t getSize() const override
+        {
+        return this->m_nBuffer;
+        }
+
+    virtual std::uint32_t getSegmentSize() const override
+        {
+        return this->m_segmentSize;
+        }
+
+    virtual bool read(std::uint32_t offset, void *pBuffer, std::size_t n) override
+        {
+        if (offset > this->m_nBuffer || n > this->m_nBuffer - offset)
+            return false;
+        std::memcpy(pBuffer, this->m_pBuffer + offset, n);
+        return true;
+        }
+
+    virtual bool write(std::uint32_t offset, const void *pBuffer, std::size_t n) override
+        {
+        if (offset > this->m_nBuffer || n > this->m_nBuffer - offset)
+            return false;
+        std::memcpy(this->m_pBuffer + offset, pBuffer, n);
+        return true;
+        }
+
+    virtual bool erase(std::uint32_t offset) override
+        {
+        if (offset > this->m_nBuffer || this->m_segmentSize > this->m_nBuffer - offset)
+            return false;
+        std::memset(this->m_pBuffer + offset, 0xFF, this->m_segmentSize);
+        return true;
+        }
+
+private:
+    std::uint8_t    *m_pBuffer;         ///< the storage
+    std::uint32_t   m_nBuffer;          ///< size of the storage
+    std::uint32_t   m_segmentSize;      ///< size of a segment
+    };
+
+///
+/// \brief Append-only store of raw samples with a time index.
+///
+/// \details
+///     The backend is used as a ring of segments. Each segment starts
+///     with a header (magic number and sequence number) and holds
+///     fixed-size records, appended in timestamp order. When the
+///     newest segment is full, the next one is erased and reused, so
+///     the oldest data is discarded.
+///
+///     Every header and record ends with a commit marker, which is
+///     written last; records also carry a CRC. After a power failure,
+///     a partly-written record has no marker (or a bad CRC) and is
+///     skipped, and mount() resumes appending after it.
+///
+///     mount() reads only the segment headers and the first record of
+///     each segment, keeping a sparse index of the first timestamp
+///     in each segment. seek() finds a time with a binary search over
+///     segments and then over the records within a segment, so
+///     questions like "the last hour" take O(log n) reads.
+///
+///     Timestamps must never go backwards, including across restarts,
+///     because the index depends on their order. Use a clock that
+///     survives a reset, such as seconds since the epoch from an RTC
+///     or from network time, not millis(). append() rejects a sample
+///     older than the newest one stored; after a loss of time, call
+///     format() to start again.
+///
+///     The layout is little-endian and independent of the host, so
+///     archives pulled from a device can be read elsewhere.
+///
+class SampleStore_t
+    {
+public:
+    /// \brief the largest number of segments supported.
+    static constexpr unsigned kMaxSegments = 64;
+
+    /// \brief the size of a segment header, in bytes.
+    static constexpr std::size_t kHeaderSize = 16;
+
+    /// \brief the size of a record, in bytes.
+    static constexpr std::size_t kRecordSize = 12;
+
+    /// \brief the segment header magic number ("LTRS").
+    static constexpr std::uint32_t kMagic = 0x5352544Cu;
+
+    /// \brief the commit marker value.
+    static constexpr std::uint8_t kCommit = 0xA5;
+
+    /// \brief one stored sample
+    struct Record_t
+        {
+        std::uint32_t   timestamp;      ///< caller's timestamp
+        std::uint8_t    data[4];        ///< data registers, in I2C order
+        AlsStatus_t     status;         ///< status register
+        AlsMeasRate_t   measrate;       ///< meas/rate register
+
+        /// \brief return the sample as a DataRegs_t.
+        DataRegs_t getDataRegs() const
+            {
+            DataRegs_t result;
+
+            std::memcpy(result.getDataPointer(), this->data, result.getDataSize());
+            result.setStatus(this->status);
+            result.setMeasRate(this->measrate);
+            return result;
+            }
+        };
+
+    /// \brief a position in the store, for iteration.
+    struct Cursor_t
+        {
+        std::uint8_t    segment;        ///< logical segment, 0 is oldest
+        std::uint16_t   slot;           ///< record slot within the segment
+        };
+
+    /// \brief construct a store on a backend; call mount() before use.
+    SampleStore_t(SampleStoreBackend_t &backend)
+        : m_backend(backend)
+        {}
+
+    // neither copyable nor movable
+    SampleStore_t(const SampleStore_t&) = delete;
+    SampleStore_t& operator=(const SampleStore_t&) = delete;
+    SampleStore_t(const SampleStore_t&&) = delete;
+    SampleStore_t& operator=(const SampleStore_t&&) = delete;
+
+    ///
+    /// \brief scan the backend and build the index.
+    ///
+    /// \return
+    ///     \c true for success. If the backend holds no store, it is
+    ///     formatted. \c false if the backend geometry is unusable or
+    ///     an I/O error occurs.
+    ///
+    bool mount();
+
+    /// \brief erase the backend and start an empty store.
+    bool format();
+
+    ///
+    /// \brief append a sample.
+    ///
+    /// \param [in] timestamp is the time of the sample; it must not be
+    ///     earlier than the newest sample stored, including one found
+    ///     by mount() after a restart (see getLastTimestamp()).
+    /// \param [in] sample is the raw sample, e.g. Ltr_329als::getRawData().
+    ///
+    /// \return \c true for success; \c false if the store isn't mounted,
+    ///     the timestamp is too early, or an I/O error occurs.
+    ///
+    bool append(std::uint32_t timestamp, const DataRegs_t &sample);
+
+    ///
+    /// \brief position a cursor at the first record at or after a time.
+    ///
+    /// \return \c true if there is such a record.
+    ///
+    bool seek(std::uint32_t timestamp, Cursor_t &cursor);
+
+    /// \brief position a cursor at the oldest record.
+    void rewind(Cursor_t &cursor) const
+        {
+        cursor.segment = 0;
+        cursor.slot = 0;
+        }
+
+    ///
+    /// \brief read the record at a cursor and advance.
+    ///
+    /// \return \c true if a record was read, \c false at the end.
+    ///
+    bool next(Cursor_t &cursor, Record_t &record);
+
+    /// \brief return the number of segments holding data.
+    unsigned getSegmentCount() const
+        {
+        return this->m_nUsed;
+        }
+
+    /// \brief return the number of record slots in a segment.
+    std::uint16_t getRecordsPerSegment() const
+        {
+        return this->m_recordsPerSegment;
+        }
+
+    /// \brief return the timestamp of the newest record.
+    std::uint32_t getLastTimestamp() const
+        {
+        return this->m_lastTimestamp;
+        }
+
+    /// \brief compute the CRC-8 used for records.
+    static std::uint8_t crc8(const std::uint8_t *p, std::size_t n);
+
+protected:
+    /// \brief return the physical segment for a logical one.
+    unsigned physical(unsigned logical) const
+        {
+        return (this->m_oldest + logical) % this->m_nSegments;
+        }
+
+    /// \brief return the backend offset of a record slot.
+    std::uint32_t slotOffset(unsigned physSegment, unsigned slot) const
+        {
+        return physSegment * this->m_segmentSize + kHeaderSize + slot * kRecordSize;
+        }
+
+    /// \brief return the number of slots in use in a logical segment.
+    std::uint16_t slotsInUse(unsigned logical) const
+        {
+        return (logical + 1 == this->m_nUsed) ? this->m_writeSlot : this->m_recordsPerSegment;
+        }
+
+    /// \brief read and validate a record; \c false if not committed.
+    bool readRecord(unsigned physSegment, unsigned slot, Record_t &record);
+
+    /// \brief return \c true if a slot has never been written.
+    bool isSlotErased(unsigned physSegment, unsigned slot);
+
+    /// \brief find the first valid record at or after \p slot; returns count if none.
+    std::uint16_t findValid(unsigned physSegment, std::uint16_t slot, std::uint16_t count, Record_t &record);
+
+    /// \brief erase a segment and write its header.
+    bool startSegment(unsigned physSegment, std::uint32_t sequence);
+
+private:
+    /// \brief sparse index entry for one segment
+    struct IndexEntry_t
+        {
+        std::uint32_t   sequence;       ///< segment sequence number
+        std::uint32_t   firstTimestamp; ///< timestamp of first valid record
+        bool            fHasRecord;     ///< true if firstTimestamp is valid
+        };
+
+    SampleStoreBackend_t &m_backend;    ///< the storage
+    IndexEntry_t    m_index[kMaxSegments];  ///< index, by physical segment
+    std::uint32_t   m_segmentSize = 0;  ///< size of a segment
+    std::uint32_t   m_lastTimestamp = 0;    ///< newest timestamp stored
+    std::uint16_t   m_recordsPerSegment = 0;    ///< slots per segment
+    std::uint16_t   m_writeSlot = 0;    ///< next free slot in newest segment
+    std::uint8_t    m_nSegments = 0;    ///< number of segments in backend
+    std::uint8_t    m_nUsed = 0;        ///< number of segments with headers
+    std::uint8_t    m_oldest = 0;       ///< physical index of oldest segment
+    bool            m_fMounted = false; ///< true if mounted
+    };
+
+} // end namespace Mcci_Ltr_329als
+
+#endif /* _mcci_ltr_329als_store_h_ */
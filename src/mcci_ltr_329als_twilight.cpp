@@ -0,0 +1,148 @@
+/*
+
+Module: mcci_ltr_329als_twilight.cpp
+
+Function:
+    Implementation code for the dusk and dawn detector.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "mcci_ltr_329als_twilight.h"
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+bool TwilightDetector_t::setThresholds(float duskLux, float dawnLux, std::uint32_t dwellMs)
+    {
+    if (! (duskLux > 0.0f && dawnLux > duskLux))
+        return false;
+
+    this->m_duskLux = duskLux;
+    this->m_dawnLux = dawnLux;
+    this->m_dwellMs = dwellMs;
+    this->m_fPending = false;
+    return true;
+    }
+
+bool TwilightDetector_t::setIntervals(std::uint32_t fastMs, std::uint32_t slowMs, float nearFactor)
+    {
+    if (fastMs == 0 || slowMs < fastMs || ! (nearFactor >= 1.0f))
+        return false;
+
+    this->m_fastMs = fastMs;
+    this->m_slowMs = slowMs;
+    this->m_nearFactor = nearFactor;
+    return true;
+    }
+
+/*
+
+Name:	TwilightDetector_t::update()
+
+Function:
+    Add a sample, and report dusk or dawn.
+
+Definition:
+    TwilightDetector_t::Event TwilightDetector_t::update(
+        std::uint32_t nowMs,
+        float lux
+        );
+
+Description:
+    The first sample sets the state: night if below the geometric
+    mean of the thresholds, day otherwise. After that, a sample past
+    the threshold for the other state starts (or continues) a
+    pending transition; a sample on this side of the threshold
+    cancels it. When a transition has been pending for the dwell
+    time, the state changes and the event is returned.
+
+Returns:
+    The event, or Event::None.
+
+*/
+
+#define FUNCTION "TwilightDetector_t::update"
+
+TwilightDetector_t::Event
+TwilightDetector_t::update(
+    std::uint32_t nowMs,
+    float lux
+    )
+    {
+    this->m_fNear = lux * this->m_nearFactor >= this->m_duskLux &&
+                    lux <= this->m_dawnLux * this->m_nearFactor;
+
+    if (this->m_state == State::Unknown)
+        {
+        this->m_state = (lux * lux < this->m_duskLux * this->m_dawnLux) ? State::Night : State::Day;
+        this->m_fPending = false;
+        return Event::None;
+        }
+
+    bool const fPast = (this->m_state == State::Day) ? lux < this->m_duskLux
+                                                     : lux > this->m_dawnLux;
+    if (! fPast)
+        {
+        this->m_fPending = false;
+        return Event::None;
+        }
+
+    if (! this->m_fPending)
+        {
+        this->m_fPending = true;
+        this->m_pendingSince = nowMs;
+        }
+
+    if (nowMs - this->m_pendingSince < this->m_dwellMs)
+        return Event::None;
+
+    this->m_fPending = false;
+    if (this->m_state == State::Day)
+        {
+        this->m_state = State::Night;
+        return Event::Dusk;
+        }
+    else
+        {
+        this->m_state = State::Day;
+        return Event::Dawn;
+        }
+    }
+
+#undef FUNCTION
+
+std::uint32_t TwilightDetector_t::getRecommendedIntervalMs(std::uint32_t nowMs) const
+    {
+    if (this->m_fPending)
+        {
+        // sample again no later than when the dwell expires. Once it
+        // has expired, the next sample confirms the transition; keep
+        // to the fast interval rather than asking for one at once.
+        std::uint32_t const elapsed = nowMs - this->m_pendingSince;
+
+        if (elapsed >= this->m_dwellMs)
+            return this->m_fastMs;
+
+        std::uint32_t const left = this->m_dwellMs - elapsed;
+
+        return (left < this->m_fastMs) ? left : this->m_fastMs;
+        }
+
+    if (this->m_state == State::Unknown || this->m_fNear)
+        return this->m_fastMs;
+
+    return this->m_slowMs;
+    }
+
+/**** end of mcci_ltr_329als_twilight.cpp ****/
@@ -0,0 +1,164 @@
+/*
+
+Module: mcci_ltr_329als_twilight.h
+
+Function:
+    Dusk and dawn detection for the MCCI LTR-329ALS library.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+/// \file
+
+#ifndef _mcci_ltr_329als_twilight_h_
+#define _mcci_ltr_329als_twilight_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <cstdint>
+
+namespace Mcci_Ltr_329als {
+
+///
+/// \brief Detect dusk and dawn in a stream of lux samples.
+///
+/// \details
+///     The detector is either in State::Day or State::Night (or
+///     State::Unknown before the first sample). Dusk is reported when
+///     the light stays below the dusk threshold for the dwell time;
+///     dawn when it stays above the dawn threshold (which must be
+///     higher, giving hysteresis) for the dwell time. Passing clouds,
+///     headlights and the like shorter than the dwell time are ignored.
+///
+///     The detector also recommends how often to sample: quickly
+///     while the light is near the thresholds or a transition is
+///     pending, and slowly while it is well into day or night. The
+///     application uses getRecommendedIntervalMs() to schedule the
+///     next single measurement, so the sensor and MCU sleep for
+///     most of the day.
+///
+class TwilightDetector_t
+    {
+public:
+    /// \brief day/night state
+    enum class State : std::uint8_t
+        {
+        Unknown,        ///< no samples yet
+        Day,            ///< light is above the dawn threshold
+        Night,          ///< light is below the dusk threshold
+        };
+
+    /// \brief events reported by update()
+    enum class Event : std::uint8_t
+        {
+        None,           ///< no transition
+        Dusk,           ///< day became night
+        Dawn,           ///< night became day
+        };
+
+    /// \brief default dusk threshold, in lux.
+    static constexpr float kDefaultDuskLux = 10.0f;
+    /// \brief default dawn threshold, in lux.
+    static constexpr float kDefaultDawnLux = 30.0f;
+    /// \brief default dwell time, in ms.
+    static constexpr std::uint32_t kDefaultDwellMs = 60 * 1000;
+    /// \brief default sampling interval near transitions, in ms.
+    static constexpr std::uint32_t kDefaultFastIntervalMs = 2 * 1000;
+    /// \brief default sampling interval in stable day or night, in ms.
+    static constexpr std::uint32_t kDefaultSlowIntervalMs = 60 * 1000;
+    /// \brief default width of the "near" band, as a factor beyond the thresholds.
+    static constexpr float kDefaultNearFactor = 4.0f;
+
+    TwilightDetector_t() = default;
+
+    ///
+    /// \brief set the thresholds and dwell time.
+    ///
+    /// \param [in] duskLux is the level below which it is night.
+    /// \param [in] dawnLux is the level above which it is day; it must
+    ///     be greater than \p duskLux.
+    /// \param [in] dwellMs is how long the light must stay past a
+    ///     threshold before the transition is reported.
+    ///
+    /// \return \c true for success, \c false for invalid parameters.
+    ///
+    bool setThresholds(float duskLux, float dawnLux, std::uint32_t dwellMs);
+
+    ///
+    /// \brief set the sampling intervals.
+    ///
+    /// \param [in] fastMs is the interval near the thresholds.
+    /// \param [in] slowMs is the interval in stable day or night; it
+    ///     must not be less than \p fastMs.
+    /// \param [in] nearFactor sets the "near" band: from
+    ///     duskLux / nearFactor to dawnLux * nearFactor. It must be at
+    ///     least 1.
+    ///
+    /// \return \c true for success, \c false for invalid parameters.
+    ///
+    bool setIntervals(std::uint32_t fastMs, std::uint32_t slowMs, float nearFactor = kDefaultNearFactor);
+
+    /// \brief forget the state; the next sample starts afresh.
+    void reset()
+        {
+        this->m_state = State::Unknown;
+        this->m_fPending = false;
+        this->m_fNear = true;
+        }
+
+    ///
+    /// \brief add a sample.
+    ///
+    /// \param [in] nowMs is the time of the sample, e.g. from millis().
+    /// \param [in] lux is the light level.
+    ///
+    /// \return the transition detected, if any. The first sample sets
+    ///     the state without reporting an event.
+    ///
+    Event update(std::uint32_t nowMs, float lux);
+
+    /// \brief return the current state.
+    State getState() const
+        {
+        return this->m_state;
+        }
+
+    /// \brief return \c true if a transition is waiting for the dwell time.
+    bool isPending() const
+        {
+        return this->m_fPending;
+        }
+
+    ///
+    /// \brief return the recommended time until the next sample.
+    ///
+    /// \return
+    ///     the fast interval if the state is unknown, a transition is
+    ///     pending, or the last sample was near the thresholds;
+    ///     otherwise the slow interval. When pending, the result is
+    ///     never more than the time left in the dwell; once the dwell
+    ///     has expired, it is the fast interval, never zero.
+    ///
+    std::uint32_t getRecommendedIntervalMs(std::uint32_t nowMs) const;
+
+private:
+    float           m_duskLux = kDefaultDuskLux;        ///< night below this
+    float           m_dawnLux = kDefaultDawnLux;        ///< day above this
+    float           m_nearFactor = kDefaultNearFactor;  ///< width of near band
+    std::uint32_t   m_dwellMs = kDefaultDwellMs;        ///< dwell time
+    std::uint32_t   m_fastMs = kDefaultFastIntervalMs;  ///< fast interval
+    std::uint32_t   m_slowMs = kDefaultSlowIntervalMs;  ///< slow interval
+    std::uint32_t   m_pendingSince = 0;                 ///< when the pending transition started
+    State           m_state = State::Unknown;           ///< current state
+    bool            m_fPending = false;                 ///< true if a transition is pending
+    bool            m_fNear = true;                     ///< true if the last sample was near the thresholds
+    };
+
+} // end namespace Mcci_Ltr_329als
+
+#endif /* _mcci_ltr_329als_twilight_h_ */
@@ -0,0 +1,68 @@
+/*
+
+Module: mcci_ltr_329als_wcet.cpp
+
+Function:
+    Implementation code for the execution time recorder.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "mcci_ltr_329als_wcet.h"
+#include "mcci_ltr_329als.h"
+#include <Arduino.h>
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+std::uint32_t WcetRecorder_t::now() const
+    {
+    if (this->m_clock != nullptr)
+        return this->m_clock();
+
+    return micros();
+    }
+
+const char *WcetRecorder_t::getMethodName(Method m)
+    {
+    static const char names[] =
+        "begin"                 "\0"
+        "startBegin"            "\0"
+        "queryBeginDone"        "\0"
+        "saveState"             "\0"
+        "resume"                "\0"
+        "readProductInfo"       "\0"
+        "reset"                 "\0"
+        "end"                   "\0"
+        "configure"             "\0"
+        "startMeasurement"      "\0"
+        "startHdrMeasurement"   "\0"
+        "startBurst"            "\0"
+        "queueBurstConfig"      "\0"
+        "getBurstRateMilliHz"   "\0"
+        "stopMeasurement"       "\0"
+        "setDeadband"           "\0"
+        "setThresholds"         "\0"
+        "getPollIntervalMs"     "\0"
+        "queryReady"            "\0"
+        "getLux"                "\0"
+        "getLux(maxAge)"        "\0"
+        "dumpStateTrace"        "\0"
+        "setInterruptThresholds"    "\0"
+        "clearInterruptThresholds"  "\0"
+        ;
+
+    return scanMultiSzString(names, unsigned(m));
+    }
+
+/**** end of mcci_ltr_329als_wcet.cpp ****/
@@ -0,0 +1,234 @@
+/*
+
+Module: mcci_ltr_329als_wcet.h
+
+Function:
+    Execution time recorder for the MCCI LTR-329ALS library.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+/// \file
+
+#ifndef _mcci_ltr_329als_wcet_h_
+#define _mcci_ltr_329als_wcet_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <cstdint>
+
+namespace Mcci_Ltr_329als {
+
+///
+/// \brief Record the worst-case execution time of driver methods.
+///
+/// \details
+///     Attach a recorder to one or more drivers with
+///     Ltr_329als::setWcetRecorder(). Each public method that is not
+///     defined inline then records its execution time, and the recorder
+///     keeps the maximum per method and flags any method that exceeds
+///     its budget. The inline accessors, and the static name lookups,
+///     take constant time and are not recorded. With no recorder
+///     attached, the cost is one test of a null pointer per call.
+///
+///     Times are in ticks of the clock function, which is \c micros()
+///     by default. For cycle-accurate figures, supply a function that
+///     reads a cycle counter (for example, the Cortex-M \c DWT->CYCCNT),
+///     and express the budgets in cycles:
+///
+///     \code
+///     static std::uint32_t cycles() { return DWT->CYCCNT; }
+///     WcetRecorder_t wcet(cycles);
+///     wcet.setBudget(2 * F_CPU / 1000);   // 2 ms for everything
+///     gLtr.setWcetRecorder(&wcet);
+///     // ... run the control loop ...
+///     if (! wcet.isWithinBudget())
+///         // report wcet.getOverrunMask() and wcet.getWorstCase()
+///     \endcode
+///
+///     Nested calls (e.g. begin() calling queryBeginDone()) are
+///     recorded under both methods. begin() itself waits for the
+///     sensor, calling \c yield() between polls, so its time includes
+///     the sensor's start-up; a control loop should use startBegin()
+///     and queryBeginDone() instead.
+///
+///     The host tests (\c test/host) run every recorded method against
+///     a simulated sensor and a bus that injects faults (write NACKs,
+///     short reads, a stuck ALS_STATUS), and fail on any overrun.
+///
+class WcetRecorder_t
+    {
+public:
+    /// \brief the clock: returns a free-running tick count.
+    using Clock_t = std::uint32_t (*)(void);
+
+    /// \brief the methods that are measured.
+    enum class Method : std::uint8_t
+        {
+        Begin,                  ///< Ltr_329als::begin()
+        StartBegin,             ///< Ltr_329als::startBegin()
+        QueryBeginDone,         ///< Ltr_329als::queryBeginDone()
+        SaveState,              ///< Ltr_329als::saveState()
+        Resume,                 ///< Ltr_329als::resume()
+        ReadProductInfo,        ///< Ltr_329als::readProductInfo()
+        Reset,                  ///< Ltr_329als::reset()
+        End,                    ///< Ltr_329als::end()
+        Configure,              ///< Ltr_329als::configure()
+        StartMeasurement,       ///< Ltr_329als::startMeasurement()
+        StartHdrMeasurement,    ///< Ltr_329als::startHdrMeasurement()
+        StartBurst,             ///< Ltr_329als::startBurst()
+        QueueBurstConfig,       ///< Ltr_329als::queueBurstConfig()
+        GetBurstRate,           ///< Ltr_329als::getBurstRateMilliHz()
+        StopMeasurement,        ///< Ltr_329als::stopMeasurement()
+        SetDeadband,            ///< Ltr_329als::setDeadband()
+        SetThresholds,          ///< Ltr_329als::setThresholds()
+        GetPollInterval,        ///< Ltr_329als::getPollIntervalMs()
+        QueryReady,             ///< Ltr_329als::queryReady()
+        GetLux,                 ///< Ltr_329als::getLux(), blocking
+        GetLuxMaxAge,           ///< Ltr_329als::getLux(maxAgeMs, lux, fError)
+        DumpStateTrace,         ///< Ltr_329als::dumpStateTrace()
+        SetInterruptThresholds,     ///< Ltr_303als::setInterruptThresholds()
+        ClearInterruptThresholds,   ///< Ltr_303als::clearInterruptThresholds()
+        nMethods                ///< number of methods; not a method.
+        };
+
+    /// \brief the number of methods.
+    static constexpr unsigned kMethods = unsigned(Method::nMethods);
+
+    static_assert(kMethods <= 32, "getOverrunMask() has one bit per method");
+
+    ///
+    /// \brief the constructor
+    ///
+    /// \param [in] clock is the clock; \c nullptr selects \c micros().
+    ///
+    WcetRecorder_t(Clock_t clock = nullptr)
+        : m_clock(clock)
+        {
+        this->setBudget(0);
+        this->reset();
+        }
+
+    /// \brief return the current clock value.
+    std::uint32_t now() const;
+
+    /// \brief set the budget of one method, in ticks; zero means no budget.
+    void setBudget(Method m, std::uint32_t ticks)
+        {
+        if (unsigned(m) < kMethods)
+            this->m_budget[unsigned(m)] = ticks;
+        }
+
+    /// \brief set the budget of every method, in ticks; zero means no budget.
+    void setBudget(std::uint32_t ticks)
+        {
+        for (auto &b : this->m_budget)
+            b = ticks;
+        }
+
+    /// \brief record one execution of a method.
+    void record(Method m, std::uint32_t ticks)
+        {
+        auto const i = unsigned(m);
+
+        if (i >= kMethods)
+            return;
+
+        ++this->m_count[i];
+        if (ticks > this->m_worst[i])
+            this->m_worst[i] = ticks;
+        if (this->m_budget[i] != 0 && ticks > this->m_budget[i])
+            this->m_overrunMask |= std::uint32_t(1) << i;
+        }
+
+    /// \brief return the longest recorded execution time of a method, in ticks.
+    std::uint32_t getWorstCase(Method m) const
+        {
+        return unsigned(m) < kMethods ? this->m_worst[unsigned(m)] : 0;
+        }
+
+    /// \brief return the number of recorded executions of a method.
+    std::uint32_t getCount(Method m) const
+        {
+        return unsigned(m) < kMethods ? this->m_count[unsigned(m)] : 0;
+        }
+
+    ///
+    /// \brief return the methods that have exceeded their budgets.
+    ///
+    /// \return a mask with bit \c i set if Method \c i has exceeded its
+    ///     budget since the last reset().
+    ///
+    std::uint32_t getOverrunMask() const
+        {
+        return this->m_overrunMask;
+        }
+
+    /// \brief return \c true if no method has exceeded its budget.
+    bool isWithinBudget() const
+        {
+        return this->m_overrunMask == 0;
+        }
+
+    /// \brief clear the recorded times (but not the budgets).
+    void reset()
+        {
+        for (unsigned i = 0; i < kMethods; ++i)
+            {
+            this->m_worst[i] = 0;
+            this->m_count[i] = 0;
+            }
+        this->m_overrunMask = 0;
+        }
+
+    /// \brief return the name of a method.
+    static const char *getMethodName(Method m);
+
+    ///
+    /// \brief measure a scope: construct at the top of a method.
+    ///
+    /// \details
+    ///     If the recorder pointer is null, nothing is measured.
+    ///
+    class Scope_t
+        {
+    public:
+        Scope_t(WcetRecorder_t *pRecorder, Method m)
+            : m_pRecorder(pRecorder)
+            , m_method(m)
+            {
+            if (pRecorder != nullptr)
+                this->m_start = pRecorder->now();
+            }
+
+        ~Scope_t()
+            {
+            if (this->m_pRecorder != nullptr)
+                this->m_pRecorder->record(this->m_method, this->m_pRecorder->now() - this->m_start);
+            }
+
+        Scope_t(const Scope_t&) = delete;
+        Scope_t& operator=(const Scope_t&) = delete;
+
+    private:
+        WcetRecorder_t  *m_pRecorder;       ///< the recorder, or null
+        std::uint32_t   m_start = 0;        ///< clock at construction
+        Method          m_method;           ///< the method being measured
+        };
+
+private:
+    Clock_t         m_clock;                ///< the clock, or null for micros()
+    std::uint32_t   m_worst[kMethods];      ///< longest time per method
+    std::uint32_t   m_count[kMethods];      ///< executions per method
+    std::uint32_t   m_budget[kMethods];     ///< budget per method; 0 for none
+    std::uint32_t   m_overrunMask;          ///< methods over budget
+    };
+
+} // end namespace Mcci_Ltr_329als
+
+#endif /* _mcci_ltr_329als_wcet_h_ */
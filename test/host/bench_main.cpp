@@ -0,0 +1,47 @@
+/*
+
+Module: bench_main.cpp
+
+Function:
+    Run the ltr_329als_benchmark example on the host, against the
+    simulated sensor and bus.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "sim_ltr329als.h"
+
+// the sketch, unchanged: it uses the global Wire and Serial.
+#include "../../examples/ltr_329als_benchmark/ltr_329als_benchmark.ino"
+
+/****************************************************************************\
+|
+|   Variables.
+|
+\****************************************************************************/
+
+static SimLtr329als_t gSim;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+int main()
+    {
+    Wire.attach(gSim);
+    gSim.setLux(300.0);
+
+    // loop() never returns; run its body once.
+    setup();
+    runBenchmark();
+    return 0;
+    }
+
+/**** end of bench_main.cpp ****/
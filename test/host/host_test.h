@@ -0,0 +1,54 @@
+/*
+
+Module: host_test.h
+
+Function:
+    Minimal checking for the host tests.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#ifndef _host_test_h_
+#define _host_test_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <cstdio>
+
+/// \brief count of failed checks in this test program.
+inline unsigned &hostTestFailures()
+    {
+    static unsigned nFailures;
+    return nFailures;
+    }
+
+/// \brief record a check; print it if it failed.
+inline bool hostCheck(bool fOk, const char *pExpr, const char *pFile, int line)
+    {
+    if (! fOk)
+        {
+        std::printf("%s:%d: check failed: %s\n", pFile, line, pExpr);
+        ++hostTestFailures();
+        }
+
+    return fOk;
+    }
+
+/// \brief check a condition, and continue.
+#define HOST_CHECK(e)   hostCheck(bool(e), #e, __FILE__, __LINE__)
+
+/// \brief print the result, and return the exit status for main().
+inline int hostTestResult(const char *pName)
+    {
+    auto const nFailures = hostTestFailures();
+
+    std::printf("%s: %s (%u failure%s)\n", pName, nFailures ? "FAIL" : "PASS", nFailures, nFailures == 1 ? "" : "s");
+    return nFailures ? 1 : 0;
+    }
+
+#endif /* _host_test_h_ */
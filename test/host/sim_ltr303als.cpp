@@ -0,0 +1,128 @@
+/*
+
+Module: sim_ltr303als.cpp
+
+Function:
+    The simulated LTR-303ALS.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "sim_ltr303als.h"
+
+/****************************************************************************\
+|
+|   Manifest constants & typedefs.
+|
+\****************************************************************************/
+
+namespace {
+
+enum : std::uint8_t
+    {
+    kStatus = 0x8C,
+    kInterrupt = 0x8F,
+    kThresUp0 = 0x97,
+    kThresUp1 = 0x98,
+    kThresLow0 = 0x99,
+    kThresLow1 = 0x9A,
+    kPersist = 0x9E,
+    };
+
+enum : std::uint8_t
+    {
+    kStatusIntr = 1u << 3,
+    kInterruptMode = 1u << 1,
+    kInterruptPolarity = 1u << 2,
+    };
+
+} // namespace
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+void SimLtr303als_t::resetRegisters()
+    {
+    this->SimLtr329als_t::resetRegisters();
+    this->m_reg[kInterrupt] = 0x08;
+    this->m_reg[kThresUp0] = 0xFF;
+    this->m_reg[kThresUp1] = 0xFF;
+    this->m_nOutside = 0;
+    this->m_fIntAsserted = false;
+    this->updatePin();
+    }
+
+void SimLtr303als_t::writeRegister(std::uint8_t r, std::uint8_t v)
+    {
+    this->SimLtr329als_t::writeRegister(r, v);
+
+    if (r == kInterrupt)
+        {
+        // disabling interrupt mode releases INT.
+        if (! (v & kInterruptMode))
+            this->m_fIntAsserted = false;
+
+        this->updatePin();
+        }
+    }
+
+void SimLtr303als_t::onRegisterRead(std::uint8_t r)
+    {
+    this->SimLtr329als_t::onRegisterRead(r);
+
+    if (r == kStatus)
+        {
+        ++this->m_nStatusReads;
+        this->m_reg[kStatus] &= ~kStatusIntr;
+        this->m_fIntAsserted = false;
+        this->updatePin();
+        }
+    }
+
+void SimLtr303als_t::onConversion(std::uint16_t ch0, std::uint16_t ch1)
+    {
+    (void) ch1;
+
+    std::uint16_t const upper = this->m_reg[kThresUp0] | (this->m_reg[kThresUp1] << 8);
+    std::uint16_t const lower = this->m_reg[kThresLow0] | (this->m_reg[kThresLow1] << 8);
+    unsigned const nPersist = (this->m_reg[kPersist] & 0x0F) + 1;
+
+    if (ch0 > upper || ch0 < lower)
+        {
+        if (this->m_nOutside < nPersist)
+            ++this->m_nOutside;
+        }
+    else
+        this->m_nOutside = 0;
+
+    if ((this->m_reg[kInterrupt] & kInterruptMode) && this->m_nOutside >= nPersist)
+        {
+        if (! this->m_fIntAsserted)
+            ++this->m_nInt;
+
+        this->m_fIntAsserted = true;
+        }
+
+    // the base class rewrote ALS_STATUS; INTR stays until it's read.
+    if (this->m_fIntAsserted)
+        this->m_reg[kStatus] |= kStatusIntr;
+
+    this->updatePin();
+    }
+
+void SimLtr303als_t::updatePin()
+    {
+    bool const fActiveHigh = this->m_reg[kInterrupt] & kInterruptPolarity;
+
+    hostSetPin(this->m_intPin, this->m_fIntAsserted == fActiveHigh ? HIGH : LOW);
+    }
+
+/**** end of sim_ltr303als.cpp ****/
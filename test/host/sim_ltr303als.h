@@ -0,0 +1,81 @@
+/*
+
+Module: sim_ltr303als.h
+
+Function:
+    A simulated LTR-303ALS, for host tests.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#ifndef _sim_ltr303als_h_
+#define _sim_ltr303als_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include "sim_ltr329als.h"
+#include <Arduino.h>
+
+///
+/// \brief Simulate an LTR-303ALS: the LTR-329ALS plus thresholds and \c INT.
+///
+/// \details
+///     When interrupt mode is enabled in \c INTERRUPT, each measurement
+///     with channel 0 above \c ALS_THRES_UP or below \c ALS_THRES_LOW
+///     counts towards the persistence in \c INTERRUPT_PERSIST; once
+///     enough consecutive measurements are out of range, \c INT is
+///     asserted and \c ALS_STATUS.INTR is set. Reading \c ALS_STATUS
+///     releases \c INT. The pin is driven with hostSetPin(), at the
+///     level given by the polarity bit, so attached handlers run.
+///
+class SimLtr303als_t : public SimLtr329als_t
+    {
+public:
+    /// \brief the simulated sensor, with \c INT wired to \p intPin.
+    SimLtr303als_t(std::uint8_t intPin)
+        : m_intPin(intPin)
+        {
+        this->powerUp(0);
+        }
+
+    /// \brief return \c true if \c INT is asserted.
+    bool getIntAsserted() const
+        {
+        return this->m_fIntAsserted;
+        }
+
+    /// \brief return the number of times \c INT has been asserted.
+    std::uint32_t getIntCount() const
+        {
+        return this->m_nInt;
+        }
+
+    /// \brief return the number of reads of \c ALS_STATUS.
+    std::uint32_t getStatusReads() const
+        {
+        return this->m_nStatusReads;
+        }
+
+protected:
+    virtual void resetRegisters() override;
+    virtual void writeRegister(std::uint8_t r, std::uint8_t v) override;
+    virtual void onRegisterRead(std::uint8_t r) override;
+    virtual void onConversion(std::uint16_t ch0, std::uint16_t ch1) override;
+
+private:
+    /// \brief drive \c INT from m_fIntAsserted and the polarity bit.
+    void updatePin();
+
+    std::uint32_t   m_nInt = 0;                 ///< times INT was asserted
+    std::uint32_t   m_nStatusReads = 0;         ///< reads of ALS_STATUS
+    std::uint8_t    m_intPin;                   ///< pin wired to INT
+    std::uint8_t    m_nOutside = 0;             ///< consecutive out-of-range measurements
+    bool            m_fIntAsserted = false;     ///< INT asserted
+    };
+
+#endif /* _sim_ltr303als_h_ */
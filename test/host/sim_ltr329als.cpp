@@ -0,0 +1,199 @@
+/*
+
+Module: sim_ltr329als.cpp
+
+Function:
+    The simulated LTR-329ALS.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "sim_ltr329als.h"
+
+/****************************************************************************\
+|
+|   Read-only data.
+|
+\****************************************************************************/
+
+static const std::uint8_t kGains[8] = { 1, 2, 4, 8, 1, 1, 48, 96 };
+static const std::uint16_t kIntegrationMs[8] = { 100, 50, 200, 400, 150, 250, 300, 350 };
+static const std::uint16_t kRateMs[8] = { 50, 100, 200, 500, 1000, 2000, 2000, 2000 };
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+void SimLtr329als_t::powerUp(std::uint32_t delayMs)
+    {
+    this->resetRegisters();
+    this->m_fPowered = true;
+    this->m_fActive = false;
+    this->m_fInWindow = false;
+    this->m_pointer = 0;
+    this->m_readyTime = hostGetMicros() + delayMs * 1000;
+    }
+
+void SimLtr329als_t::resetRegisters()
+    {
+    memset(this->m_reg, 0, sizeof(this->m_reg));
+    this->m_reg[0x85] = 0x03;
+    this->m_reg[0x86] = 0xA0;
+    this->m_reg[0x87] = 0x05;
+    }
+
+void SimLtr329als_t::update()
+    {
+    if (! (this->m_fPowered && this->m_fActive))
+        return;
+
+    for (;;)
+        {
+        if (! this->m_fInWindow)
+            {
+            if (! isReached(this->m_nextWindow))
+                break;
+
+            this->startWindow(this->m_nextWindow);
+            }
+        else if (isReached(this->m_windowEnd))
+            this->endWindow();
+        else
+            break;
+        }
+    }
+
+void SimLtr329als_t::startWindow(std::uint32_t t)
+    {
+    this->m_windowStart = t;
+    this->m_windowGainBits = (this->m_reg[0x80] >> 2) & 7;
+    this->m_windowItime = kIntegrationMs[(this->m_reg[0x85] >> 3) & 7];
+    this->m_windowRate = kRateMs[this->m_reg[0x85] & 7];
+    this->m_windowEnd = t + this->m_windowItime * 1000u;
+    this->m_fInWindow = true;
+    }
+
+void SimLtr329als_t::endWindow()
+    {
+    // invert the lux formula for the ratio region below 0.45.
+    double const q = this->m_irFraction / (1.0 - this->m_irFraction);
+    double const scale = kGains[this->m_windowGainBits] * this->m_windowItime / 100.0;
+    double c0 = this->m_lux * scale / (1.7743 + 1.1059 * q);
+    double c1 = c0 * q;
+
+    if (c0 > 65535.0)
+        c0 = 65535.0;
+    if (c1 > 65535.0)
+        c1 = 65535.0;
+
+    auto const ch0 = std::uint16_t(c0 + 0.5);
+    auto const ch1 = std::uint16_t(c1 + 0.5);
+
+    this->m_reg[0x88] = std::uint8_t(ch1);
+    this->m_reg[0x89] = std::uint8_t(ch1 >> 8);
+    this->m_reg[0x8A] = std::uint8_t(ch0);
+    this->m_reg[0x8B] = std::uint8_t(ch0 >> 8);
+    this->m_reg[0x8C] = std::uint8_t(this->m_windowGainBits << 4);
+    if (! this->m_fStuckStatus)
+        this->m_reg[0x8C] |= 0x04;
+
+    ++this->m_nConversions;
+    this->m_fInWindow = false;
+
+    // the period runs from the start of one window to the next.
+    std::uint32_t const periodMs = this->m_windowRate > this->m_windowItime ? this->m_windowRate : this->m_windowItime;
+    this->m_nextWindow = this->m_windowStart + periodMs * 1000;
+
+    this->onConversion(ch0, ch1);
+    }
+
+bool SimLtr329als_t::isAddressed(std::uint8_t address) const
+    {
+    return this->m_fPowered && address == kAddress && isReached(this->m_readyTime);
+    }
+
+bool SimLtr329als_t::onWrite(std::uint8_t address, const std::uint8_t *pBuffer, size_t nBuffer)
+    {
+    (void) address;
+    this->update();
+
+    if (nBuffer == 0)
+        return true;
+
+    this->m_pointer = pBuffer[0];
+    for (size_t i = 1; i < nBuffer; ++i)
+        {
+        ++this->m_nWrites;
+        this->writeRegister(this->m_pointer++, pBuffer[i]);
+        }
+
+    return true;
+    }
+
+size_t SimLtr329als_t::onRead(std::uint8_t address, std::uint8_t *pBuffer, size_t nBuffer)
+    {
+    (void) address;
+    this->update();
+
+    for (size_t i = 0; i < nBuffer; ++i)
+        {
+        std::uint8_t const r = this->m_pointer++;
+
+        pBuffer[i] = this->m_reg[r];
+        this->onRegisterRead(r);
+        }
+
+    return nBuffer;
+    }
+
+void SimLtr329als_t::writeRegister(std::uint8_t r, std::uint8_t v)
+    {
+    if (r == 0x80)
+        {
+        // software reset: back to power-up defaults, briefly deaf.
+        if (v & 0x02)
+            {
+            this->resetRegisters();
+            this->m_fActive = false;
+            this->m_fInWindow = false;
+            this->m_readyTime = hostGetMicros() + kResetMs * 1000;
+            return;
+            }
+
+        this->m_reg[r] = v;
+        if (! (v & 0x01))
+            {
+            this->m_fActive = false;
+            this->m_fInWindow = false;
+            }
+        else if (! this->m_fActive)
+            {
+            this->m_fActive = true;
+            this->m_nextWindow = hostGetMicros() + kWakeupMs * 1000;
+            }
+
+        return;
+        }
+
+    // PART_ID through ALS_STATUS are read-only.
+    if (0x86 <= r && r <= 0x8C)
+        return;
+
+    this->m_reg[r] = v;
+    }
+
+void SimLtr329als_t::onRegisterRead(std::uint8_t r)
+    {
+    // "new" means "not yet read".
+    if (0x88 <= r && r <= 0x8B)
+        this->m_reg[0x8C] &= ~0x04;
+    }
+
+/**** end of sim_ltr329als.cpp ****/
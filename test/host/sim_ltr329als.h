@@ -0,0 +1,154 @@
+/*
+
+Module: sim_ltr329als.h
+
+Function:
+    A simulated LTR-329ALS, for host tests.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#ifndef _sim_ltr329als_h_
+#define _sim_ltr329als_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <Wire.h>
+
+///
+/// \brief Simulate the registers and measurement cycle of an LTR-329ALS.
+///
+/// \details
+///     The sensor answers at its I2C address once the power-up delay
+///     has passed. While active, it runs back-to-back measurements: each
+///     integration window latches the gain, integration time and rate
+///     in effect when it starts, and when it ends the data registers
+///     and \c ALS_STATUS are updated from the simulated light level.
+///     The next window starts one measurement period after the start
+///     of the last one. Reading the data clears the "new" status bit.
+///
+///     The model is advanced lazily, from the host clock, whenever the
+///     sensor is accessed or update() is called.
+///
+class SimLtr329als_t : public TwoWireTarget_t
+    {
+public:
+    /// \brief the I2C address.
+    static constexpr std::uint8_t kAddress = 0x29;
+    /// \brief the delay from power-up until the sensor answers, in ms.
+    static constexpr std::uint32_t kPowerUpMs = 100;
+    /// \brief the delay after a software reset until the sensor answers, in ms.
+    static constexpr std::uint32_t kResetMs = 2;
+    /// \brief the delay from standby to the first integration window, in ms.
+    static constexpr std::uint32_t kWakeupMs = 10;
+
+    SimLtr329als_t()
+        {
+        this->powerUp(0);
+        }
+
+    /// \brief apply power now; the sensor answers after \p delayMs.
+    void powerUp(std::uint32_t delayMs = kPowerUpMs);
+
+    /// \brief remove power; the sensor doesn't answer until powerUp().
+    void powerDown()
+        {
+        this->m_fPowered = false;
+        }
+
+    /// \brief set the light level, and the fraction of the counts from infrared.
+    void setLux(double lux, double irFraction = 0.2)
+        {
+        this->update();
+        this->m_lux = lux;
+        this->m_irFraction = irFraction;
+        }
+
+    /// \brief make \c ALS_STATUS never report new data (or clear that fault).
+    void setStuckStatus(bool fStuck)
+        {
+        this->m_fStuckStatus = fStuck;
+        }
+
+    /// \brief advance the model to the current time.
+    void update();
+
+    /// \brief return a register value.
+    std::uint8_t getRegister(std::uint8_t r) const
+        {
+        return this->m_reg[r];
+        }
+
+    /// \brief return the number of measurements completed.
+    std::uint32_t getConversions() const
+        {
+        return this->m_nConversions;
+        }
+
+    /// \brief return the number of writes to registers.
+    std::uint32_t getRegisterWrites() const
+        {
+        return this->m_nWrites;
+        }
+
+    // TwoWireTarget_t
+    virtual bool isAddressed(std::uint8_t address) const override;
+    virtual bool onWrite(std::uint8_t address, const std::uint8_t *pBuffer, size_t nBuffer) override;
+    virtual size_t onRead(std::uint8_t address, std::uint8_t *pBuffer, size_t nBuffer) override;
+
+protected:
+    /// \brief set the registers to their reset values.
+    virtual void resetRegisters();
+
+    /// \brief store a register written by the host.
+    virtual void writeRegister(std::uint8_t r, std::uint8_t v);
+
+    /// \brief called when a register is read by the host.
+    virtual void onRegisterRead(std::uint8_t r);
+
+    /// \brief called when a measurement ends, after the registers are updated.
+    virtual void onConversion(std::uint16_t ch0, std::uint16_t ch1)
+        {
+        (void) ch0;
+        (void) ch1;
+        }
+
+    /// \brief return \c true if time \p t (in us) has been reached.
+    static bool isReached(std::uint32_t t)
+        {
+        return std::int32_t(hostGetMicros() - t) >= 0;
+        }
+
+    std::uint8_t    m_reg[256];                 ///< the register file
+
+private:
+    /// \brief start an integration window at time \p t (in us).
+    void startWindow(std::uint32_t t);
+
+    /// \brief end the current integration window.
+    void endWindow();
+
+    double          m_lux = 100.0;              ///< simulated light level
+    double          m_irFraction = 0.2;         ///< ch1 / (ch0 + ch1)
+    std::uint32_t   m_readyTime = 0;            ///< answers from this time
+    std::uint32_t   m_windowStart = 0;          ///< start of current window
+    std::uint32_t   m_windowEnd = 0;            ///< end of current window
+    std::uint32_t   m_nextWindow = 0;           ///< start of the next window
+    std::uint32_t   m_nConversions = 0;         ///< measurements completed
+    std::uint32_t   m_nWrites = 0;              ///< register writes
+    std::uint16_t   m_windowItime = 100;        ///< latched integration time, ms
+    std::uint16_t   m_windowRate = 500;         ///< latched measurement rate, ms
+    std::uint8_t    m_windowGainBits = 0;       ///< latched gain
+    std::uint8_t    m_pointer = 0;              ///< register address pointer
+    bool            m_fPowered = false;         ///< power applied
+    bool            m_fActive = false;          ///< measuring
+    bool            m_fInWindow = false;        ///< integration window running
+    bool            m_fStuckStatus = false;     ///< fault: never report new data
+    };
+
+#endif /* _sim_ltr329als_h_ */
@@ -0,0 +1,94 @@
+/*
+
+Module: sim_tca9548a.cpp
+
+Function:
+    The simulated TCA9548A.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "sim_tca9548a.h"
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+TwoWireTarget_t *SimTca9548a_t::getTarget(unsigned i, std::uint8_t address) const
+    {
+    auto const pTarget = this->m_pTarget[i];
+
+    if (! (this->m_control & (1u << i)) || pTarget == nullptr)
+        return nullptr;
+
+    return pTarget->isAddressed(address) ? pTarget : nullptr;
+    }
+
+bool SimTca9548a_t::isAddressed(std::uint8_t address) const
+    {
+    if (address == this->m_address)
+        return true;
+
+    for (unsigned i = 0; i < kChannels; ++i)
+        {
+        if (this->getTarget(i, address) != nullptr)
+            return true;
+        }
+
+    return false;
+    }
+
+bool SimTca9548a_t::onWrite(std::uint8_t address, const std::uint8_t *pBuffer, size_t nBuffer)
+    {
+    if (address == this->m_address)
+        {
+        if (nBuffer != 1)
+            return false;
+
+        this->m_control = pBuffer[0];
+        ++this->m_nSelects;
+        return true;
+        }
+
+    bool fAck = false;
+    for (unsigned i = 0; i < kChannels; ++i)
+        {
+        auto const pTarget = this->getTarget(i, address);
+
+        if (pTarget != nullptr && pTarget->onWrite(address, pBuffer, nBuffer))
+            fAck = true;
+        }
+
+    return fAck;
+    }
+
+size_t SimTca9548a_t::onRead(std::uint8_t address, std::uint8_t *pBuffer, size_t nBuffer)
+    {
+    if (address == this->m_address)
+        {
+        if (nBuffer == 0)
+            return 0;
+
+        pBuffer[0] = this->m_control;
+        return 1;
+        }
+
+    for (unsigned i = 0; i < kChannels; ++i)
+        {
+        auto const pTarget = this->getTarget(i, address);
+
+        if (pTarget != nullptr)
+            return pTarget->onRead(address, pBuffer, nBuffer);
+        }
+
+    return 0;
+    }
+
+/**** end of sim_tca9548a.cpp ****/
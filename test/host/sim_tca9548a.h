@@ -0,0 +1,70 @@
+/*
+
+Module: sim_tca9548a.h
+
+Function:
+    A simulated TCA9548A I2C switch, for host tests.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#ifndef _sim_tca9548a_h_
+#define _sim_tca9548a_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <Wire.h>
+
+///
+/// \brief Simulate a TCA9548A with a target on each channel.
+///
+/// \details
+///     Writing the control register enables a set of channels. A write
+///     to any other address goes to every enabled target that answers
+///     at it (so broadcast writes work); a read comes from the enabled
+///     target with the lowest channel number.
+///
+class SimTca9548a_t : public TwoWireTarget_t
+    {
+public:
+    /// \brief the number of channels.
+    static constexpr unsigned kChannels = 8;
+
+    SimTca9548a_t(std::uint8_t address = 0x70)
+        : m_address(address)
+        {}
+
+    /// \brief put a target on a channel.
+    void connect(unsigned channel, TwoWireTarget_t &target)
+        {
+        if (channel < kChannels)
+            this->m_pTarget[channel] = &target;
+        }
+
+    /// \brief return the number of writes to the control register.
+    std::uint32_t getSelects() const
+        {
+        return this->m_nSelects;
+        }
+
+    // TwoWireTarget_t
+    virtual bool isAddressed(std::uint8_t address) const override;
+    virtual bool onWrite(std::uint8_t address, const std::uint8_t *pBuffer, size_t nBuffer) override;
+    virtual size_t onRead(std::uint8_t address, std::uint8_t *pBuffer, size_t nBuffer) override;
+
+private:
+    /// \brief return the target on channel \p i if it's enabled and answers at \p address.
+    TwoWireTarget_t *getTarget(unsigned i, std::uint8_t address) const;
+
+    TwoWireTarget_t *m_pTarget[kChannels] = {};    ///< downstream targets
+    std::uint32_t   m_nSelects = 0;                 ///< control register writes
+    std::uint8_t    m_address;                      ///< switch address
+    std::uint8_t    m_control = 0;                  ///< enabled channels
+    };
+
+#endif /* _sim_tca9548a_h_ */
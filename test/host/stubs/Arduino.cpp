@@ -0,0 +1,177 @@
+/*
+
+Module: Arduino.cpp
+
+Function:
+    The host implementation of the Arduino API subset.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include <Arduino.h>
+#include <cstdio>
+
+/****************************************************************************\
+|
+|   Variables.
+|
+\****************************************************************************/
+
+HardwareSerial Serial;
+
+// the simulated time; 64 bits so that millis() wraps as on the target.
+static std::uint64_t gMicros;
+
+// the cost of reading the clock, so that polling loops make progress.
+static std::uint32_t gClockReadMicros = 10;
+
+static std::uint8_t gPin[64];
+
+// the interrupt handler and mode of each pin.
+static void (*gpHandler[sizeof(gPin)])(void);
+static int gHandlerMode[sizeof(gPin)];
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+std::uint32_t millis(void)
+    {
+    gMicros += gClockReadMicros;
+    return std::uint32_t(gMicros / 1000);
+    }
+
+std::uint32_t micros(void)
+    {
+    gMicros += gClockReadMicros;
+    return std::uint32_t(gMicros);
+    }
+
+void delay(std::uint32_t ms)
+    {
+    gMicros += std::uint64_t(ms) * 1000;
+    }
+
+void yield(void)
+    {
+    gMicros += gClockReadMicros;
+    }
+
+std::uint32_t hostGetMicros()
+    {
+    return std::uint32_t(gMicros);
+    }
+
+void hostAdvanceMicros(std::uint32_t us)
+    {
+    gMicros += us;
+    }
+
+void hostSetClockReadMicros(std::uint32_t us)
+    {
+    gClockReadMicros = us;
+    }
+
+size_t Print::print(const char *s)
+    {
+    size_t n = 0;
+
+    while (*s != '\0')
+        n += this->write(std::uint8_t(*s++));
+
+    return n;
+    }
+
+size_t Print::print(unsigned long v, int base)
+    {
+    char buf[24];
+
+    snprintf(buf, sizeof(buf), base == 16 ? "%lX" : base == 8 ? "%lo" : "%lu", v);
+    return this->print(buf);
+    }
+
+size_t Print::print(long v, int base)
+    {
+    if (base != 10)
+        return this->print((unsigned long) v, base);
+
+    char buf[24];
+
+    snprintf(buf, sizeof(buf), "%ld", v);
+    return this->print(buf);
+    }
+
+size_t Print::print(double v, int digits)
+    {
+    char buf[48];
+
+    snprintf(buf, sizeof(buf), "%.*f", digits, v);
+    return this->print(buf);
+    }
+
+size_t HardwareSerial::write(std::uint8_t c)
+    {
+    // drop the CR of each CRLF.
+    if (c != '\r')
+        putchar(c);
+
+    return 1;
+    }
+
+void pinMode(std::uint8_t pin, std::uint8_t mode)
+    {
+    (void) pin;
+    (void) mode;
+    }
+
+void digitalWrite(std::uint8_t pin, std::uint8_t value)
+    {
+    if (pin < sizeof(gPin))
+        gPin[pin] = value != LOW;
+    }
+
+int digitalRead(std::uint8_t pin)
+    {
+    return pin < sizeof(gPin) ? gPin[pin] : LOW;
+    }
+
+void attachInterrupt(int interrupt, void (*pHandler)(void), int mode)
+    {
+    if (unsigned(interrupt) < sizeof(gPin))
+        {
+        gpHandler[interrupt] = pHandler;
+        gHandlerMode[interrupt] = mode;
+        }
+    }
+
+void detachInterrupt(int interrupt)
+    {
+    if (unsigned(interrupt) < sizeof(gPin))
+        gpHandler[interrupt] = nullptr;
+    }
+
+void hostSetPin(std::uint8_t pin, std::uint8_t value)
+    {
+    if (pin >= sizeof(gPin))
+        return;
+
+    std::uint8_t const old = gPin[pin];
+    std::uint8_t const now = value != LOW;
+
+    gPin[pin] = now;
+    if (old == now || gpHandler[pin] == nullptr)
+        return;
+
+    auto const mode = gHandlerMode[pin];
+    if (mode == CHANGE || (mode == RISING && now) || (mode == FALLING && ! now))
+        gpHandler[pin]();
+    }
+
+/**** end of Arduino.cpp ****/
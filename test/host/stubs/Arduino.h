@@ -0,0 +1,127 @@
+/*
+
+Module: Arduino.h
+
+Function:
+    The subset of the Arduino API used by the library, for host builds.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#ifndef _Arduino_h_
+#define _Arduino_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/****************************************************************************\
+|
+|   Time. The host clock is simulated: it only moves when the code under
+|   test reads it, waits, or uses the bus, so runs are repeatable.
+|
+\****************************************************************************/
+
+extern "C" {
+std::uint32_t millis(void);
+std::uint32_t micros(void);
+void delay(std::uint32_t ms);
+void yield(void);
+}
+
+/// \brief return the simulated time in microseconds, without advancing it.
+std::uint32_t hostGetMicros();
+
+/// \brief advance the simulated time.
+void hostAdvanceMicros(std::uint32_t us);
+
+/// \brief set how far each call to millis() or micros() advances the time.
+void hostSetClockReadMicros(std::uint32_t us);
+
+/****************************************************************************\
+|
+|   Output.
+|
+\****************************************************************************/
+
+class Print
+    {
+public:
+    virtual ~Print() = default;
+    virtual size_t write(std::uint8_t c) = 0;
+
+    size_t print(const char *s);
+    size_t print(char c)                { return this->write(std::uint8_t(c)); }
+    size_t print(unsigned long v, int base = 10);
+    size_t print(long v, int base = 10);
+    size_t print(unsigned v, int base = 10)         { return this->print((unsigned long) v, base); }
+    size_t print(int v, int base = 10)              { return this->print((long) v, base); }
+    size_t print(unsigned char v, int base = 10)    { return this->print((unsigned long) v, base); }
+    size_t print(double v, int digits = 2);
+    size_t println()                    { return this->print("\r\n"); }
+
+    template <typename T>
+    size_t println(T v)                 { size_t const n = this->print(v); return n + this->println(); }
+
+    template <typename T>
+    size_t println(T v, int arg)        { size_t const n = this->print(v, arg); return n + this->println(); }
+    };
+
+/// \brief the serial port writes to \c stdout.
+class HardwareSerial : public Print
+    {
+public:
+    void begin(unsigned long) {}
+    virtual size_t write(std::uint8_t c) override;
+    explicit operator bool() const      { return true; }
+    };
+
+extern HardwareSerial Serial;
+
+/****************************************************************************\
+|
+|   Pins.
+|
+\****************************************************************************/
+
+#define LOW             0
+#define HIGH            1
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+#define LED_BUILTIN     13
+
+#define CHANGE          1
+#define FALLING         2
+#define RISING          3
+
+void pinMode(std::uint8_t pin, std::uint8_t mode);
+void digitalWrite(std::uint8_t pin, std::uint8_t value);
+int digitalRead(std::uint8_t pin);
+
+/****************************************************************************\
+|
+|   Interrupts. Each pin is its own interrupt; a handler runs when a
+|   simulated device drives the pin with hostSetPin().
+|
+\****************************************************************************/
+
+inline int digitalPinToInterrupt(std::uint8_t pin)
+    {
+    return pin;
+    }
+
+void attachInterrupt(int interrupt, void (*pHandler)(void), int mode);
+void detachInterrupt(int interrupt);
+
+/// \brief drive an input pin from a simulated device; runs any handler for the edge.
+void hostSetPin(std::uint8_t pin, std::uint8_t value);
+
+#endif /* _Arduino_h_ */
@@ -0,0 +1,184 @@
+/*
+
+Module: Wire.cpp
+
+Function:
+    The simulated I2C bus.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include <Wire.h>
+
+/****************************************************************************\
+|
+|   Variables.
+|
+\****************************************************************************/
+
+TwoWire Wire;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+void TwoWire::beginTransmission(std::uint8_t address)
+    {
+    this->m_txAddress = address;
+    this->m_nTx = 0;
+    }
+
+size_t TwoWire::write(std::uint8_t b)
+    {
+    if (this->m_nTx >= kBufferSize)
+        return 0;
+
+    this->m_txBuffer[this->m_nTx++] = b;
+    return 1;
+    }
+
+size_t TwoWire::write(const std::uint8_t *pBuffer, size_t nBuffer)
+    {
+    size_t n = 0;
+
+    while (n < nBuffer && this->write(pBuffer[n]) == 1)
+        ++n;
+
+    return n;
+    }
+
+std::uint8_t TwoWire::endTransmission(bool fStop)
+    {
+    (void) fStop;
+    auto const pTarget = this->findTarget(this->m_txAddress);
+
+    // address NACK: only the address byte is on the bus.
+    if (this->takeFault(Fault::NackWrite) || pTarget == nullptr)
+        {
+        this->finishTransfer(0);
+        return 2;
+        }
+
+    bool const fAck = pTarget->onWrite(this->m_txAddress, this->m_txBuffer, this->m_nTx);
+
+    this->finishTransfer(this->m_nTx);
+    return fAck ? 0 : 3;
+    }
+
+std::uint8_t TwoWire::requestFrom(std::uint8_t address, std::uint8_t nBytes, bool fStop)
+    {
+    (void) fStop;
+    auto const pTarget = this->findTarget(address);
+
+    this->m_nRx = 0;
+    this->m_iRx = 0;
+
+    if (nBytes > kBufferSize)
+        nBytes = kBufferSize;
+
+    if (pTarget == nullptr)
+        {
+        this->finishTransfer(0);
+        return 0;
+        }
+
+    auto n = std::uint8_t(pTarget->onRead(address, this->m_rxBuffer, nBytes));
+
+    if (n > 0 && this->takeFault(Fault::ShortRead))
+        --n;
+
+    this->m_nRx = n;
+    this->finishTransfer(n);
+    return n;
+    }
+
+int TwoWire::available()
+    {
+    return this->m_nRx - this->m_iRx;
+    }
+
+int TwoWire::read()
+    {
+    if (this->m_iRx >= this->m_nRx)
+        return -1;
+
+    return this->m_rxBuffer[this->m_iRx++];
+    }
+
+bool TwoWire::attach(TwoWireTarget_t &target)
+    {
+    if (this->m_nTargets >= kMaxTargets)
+        return false;
+
+    this->m_pTarget[this->m_nTargets++] = &target;
+    return true;
+    }
+
+void TwoWire::reset()
+    {
+    this->m_nTargets = 0;
+    this->m_fault = Fault::None;
+    this->m_nFaults = 0;
+    this->m_nTransfers = 0;
+    this->m_nBytes = 0;
+    this->m_pHook = nullptr;
+    this->m_sclHz = 100000;
+    }
+
+void TwoWire::injectFault(Fault fault, std::uint32_t nSkip, std::uint32_t nCount)
+    {
+    this->m_fault = fault;
+    this->m_faultSkip = nSkip;
+    this->m_faultCount = nCount;
+    }
+
+TwoWireTarget_t *TwoWire::findTarget(std::uint8_t address) const
+    {
+    for (unsigned i = 0; i < this->m_nTargets; ++i)
+        {
+        if (this->m_pTarget[i]->isAddressed(address))
+            return this->m_pTarget[i];
+        }
+
+    return nullptr;
+    }
+
+bool TwoWire::takeFault(Fault fault)
+    {
+    if (this->m_fault != fault || this->m_faultCount == 0)
+        return false;
+
+    if (this->m_faultSkip != 0)
+        {
+        --this->m_faultSkip;
+        return false;
+        }
+
+    if (this->m_faultCount != kForever)
+        --this->m_faultCount;
+
+    ++this->m_nFaults;
+    return true;
+    }
+
+void TwoWire::finishTransfer(size_t nBytes)
+    {
+    // START, address and data bytes (8 bits and ACK each), STOP and bus free time.
+    std::uint32_t const bits = std::uint32_t(1 + nBytes) * 9;
+
+    hostAdvanceMicros((bits * 1000000u + this->m_sclHz - 1) / this->m_sclHz + 10);
+
+    ++this->m_nTransfers;
+    this->m_nBytes += nBytes;
+    if (this->m_pHook != nullptr)
+        this->m_pHook(this->m_pHookContext, nBytes);
+    }
+
+/**** end of Wire.cpp ****/
@@ -0,0 +1,142 @@
+/*
+
+Module: Wire.h
+
+Function:
+    A simulated I2C bus with the Arduino TwoWire API, for host builds.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#ifndef _Wire_h_
+#define _Wire_h_ /* prevent multiple includes */
+
+#pragma once
+
+#include <Arduino.h>
+
+///
+/// \brief a simulated device on the bus.
+///
+class TwoWireTarget_t
+    {
+public:
+    virtual ~TwoWireTarget_t() = default;
+
+    /// \brief return \c true if the target answers at \p address.
+    virtual bool isAddressed(std::uint8_t address) const = 0;
+
+    /// \brief receive a write; return \c true to acknowledge it.
+    virtual bool onWrite(std::uint8_t address, const std::uint8_t *pBuffer, size_t nBuffer) = 0;
+
+    /// \brief supply the bytes for a read; return the number supplied.
+    virtual size_t onRead(std::uint8_t address, std::uint8_t *pBuffer, size_t nBuffer) = 0;
+    };
+
+///
+/// \brief the bus.
+///
+/// \details
+///     Transfers go to the attached targets, and advance the host clock
+///     by their time on the bus. Faults can be injected to test error
+///     handling: a write that isn't acknowledged, or a read that
+///     returns too few bytes.
+///
+class TwoWire
+    {
+public:
+    /// \brief the size of the transmit and receive buffers.
+    static constexpr size_t kBufferSize = 32;
+
+    /// \brief a fault count meaning "until cleared".
+    static constexpr std::uint32_t kForever = UINT32_MAX;
+
+    /// \brief the faults that can be injected.
+    enum class Fault : std::uint8_t
+        {
+        None,           ///< no fault
+        NackWrite,      ///< endTransmission(): the address isn't acknowledged
+        ShortRead,      ///< requestFrom(): one byte less than requested
+        };
+
+    /// \brief called after each transfer with the number of data bytes.
+    using TransferHook_t = void (void *pContext, size_t nBytes);
+
+    // the Arduino API
+    void begin() {}
+    void setClock(std::uint32_t sclHz)  { this->m_sclHz = sclHz; }
+    void beginTransmission(std::uint8_t address);
+    size_t write(std::uint8_t b);
+    size_t write(const std::uint8_t *pBuffer, size_t nBuffer);
+    std::uint8_t endTransmission(bool fStop = true);
+    std::uint8_t requestFrom(std::uint8_t address, std::uint8_t nBytes, bool fStop = true);
+    int available();
+    int read();
+
+    /// \brief attach a target; returns \c false if there are too many.
+    bool attach(TwoWireTarget_t &target);
+
+    /// \brief detach all targets, clear the fault and the counters.
+    void reset();
+
+    ///
+    /// \brief inject a fault.
+    ///
+    /// \param [in] fault is the fault.
+    /// \param [in] nSkip is the number of transfers of the affected
+    ///     kind (writes or reads) to let through first.
+    /// \param [in] nCount is the number of transfers that fail, or
+    ///     kForever.
+    ///
+    void injectFault(Fault fault, std::uint32_t nSkip = 0, std::uint32_t nCount = 1);
+
+    /// \brief return the number of faults injected so far.
+    std::uint32_t getFaultCount() const { return this->m_nFaults; }
+
+    /// \brief return the number of transfers (address phases) on the bus.
+    std::uint32_t getTransfers() const  { return this->m_nTransfers; }
+
+    /// \brief return the number of data bytes on the bus, not counting addresses.
+    std::uint64_t getBytes() const      { return this->m_nBytes; }
+
+    /// \brief set a function to be called after each transfer.
+    void setTransferHook(TransferHook_t *pHook, void *pContext)
+        {
+        this->m_pHook = pHook;
+        this->m_pHookContext = pContext;
+        }
+
+private:
+    TwoWireTarget_t *findTarget(std::uint8_t address) const;
+    bool takeFault(Fault fault);
+    void finishTransfer(size_t nBytes);
+
+    static constexpr unsigned kMaxTargets = 16;
+
+    TwoWireTarget_t *m_pTarget[kMaxTargets] = {};
+    unsigned        m_nTargets = 0;
+    std::uint8_t    m_txBuffer[kBufferSize];
+    std::uint8_t    m_rxBuffer[kBufferSize];
+    std::uint8_t    m_txAddress = 0;
+    std::uint8_t    m_nTx = 0;
+    std::uint8_t    m_nRx = 0;
+    std::uint8_t    m_iRx = 0;
+    std::uint32_t   m_sclHz = 100000;
+    Fault           m_fault = Fault::None;
+    std::uint32_t   m_faultSkip = 0;
+    std::uint32_t   m_faultCount = 0;
+    std::uint32_t   m_nFaults = 0;
+    std::uint32_t   m_nTransfers = 0;
+    std::uint64_t   m_nBytes = 0;
+    TransferHook_t  *m_pHook = nullptr;
+    void            *m_pHookContext = nullptr;
+    };
+
+extern TwoWire Wire;
+
+#endif /* _Wire_h_ */
@@ -0,0 +1,140 @@
+/*
+
+Module: test_accounting.cpp
+
+Function:
+    Check the driver's account of bus traffic against the bus itself.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "host_test.h"
+#include "sim_ltr329als.h"
+#include <mcci_ltr_329als.h>
+#include <mcci_ltr_329als_i2csched.h>
+#include <mcci_ltr_329als_i2ctiming.h>
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Manifest constants & typedefs.
+|
+\****************************************************************************/
+
+using Fault = TwoWire::Fault;
+
+/// the longest wait for a sample, in ms.
+static constexpr std::uint32_t kSampleLimitMs = 2000;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+// the bus reports each transfer here.
+static void countTransfer(void *pContext, size_t nBytes)
+    {
+    static_cast<I2cBusTiming_t *>(pContext)->addTransfer(nBytes);
+    }
+
+// poll for a sample; give up on error or after kSampleLimitMs.
+static bool waitReady(Ltr_329als &ltr)
+    {
+    auto const tStart = millis();
+    bool fError;
+
+    while (millis() - tStart < kSampleLimitMs)
+        {
+        if (ltr.queryReady(fError))
+            return true;
+        if (fError)
+            return false;
+        }
+
+    return false;
+    }
+
+// run a scenario with one fault; the driver's account must match the bus.
+// Return the number of transfers.
+static std::uint32_t runOnce(bool fScheduled, Fault fault, std::uint32_t nSkip)
+    {
+    SimLtr329als_t sim;
+    Ltr_329als ltr {Wire};
+    I2cScheduler_t scheduler;
+    I2cBusTiming_t driverTiming;
+    I2cBusTiming_t busTiming;
+
+    Wire.reset();
+    Wire.attach(sim);
+    Wire.setTransferHook(countTransfer, &busTiming);
+    ltr.setBusTiming(&driverTiming);
+    if (fScheduled)
+        ltr.setScheduler(&scheduler);
+
+    Wire.injectFault(fault, nSkip, 1);
+
+    // each step may fail; carry on, so later steps run against the fault.
+    if (! ltr.begin())
+        ltr.begin();
+    ltr.readProductInfo();
+    ltr.startMeasurement(true);
+    waitReady(ltr);
+    ltr.startMeasurement(false);
+    for (unsigned i = 0; i < 3; ++i)
+        waitReady(ltr);
+    ltr.stopMeasurement();
+    ltr.end();
+
+    auto const &stats = ltr.getStatistics();
+    bool const fMatch =
+        HOST_CHECK(driverTiming.getTransfers() == busTiming.getTransfers()) &&
+        HOST_CHECK(driverTiming.getBusyNs() == busTiming.getBusyNs()) &&
+        HOST_CHECK(stats.nI2cTransfers == Wire.getTransfers()) &&
+        HOST_CHECK(stats.nI2cBytes == Wire.getBytes());
+
+    if (! fMatch)
+        std::printf("  %s, fault %u at transfer %u: driver %u transfers %u ns, bus %u transfers %u ns\n",
+            fScheduled ? "scheduled" : "direct",
+            unsigned(fault), unsigned(nSkip),
+            unsigned(driverTiming.getTransfers()), unsigned(driverTiming.getBusyNs()),
+            unsigned(busTiming.getTransfers()), unsigned(busTiming.getBusyNs())
+            );
+
+    return Wire.getTransfers();
+    }
+
+static void testPath(bool fScheduled)
+    {
+    static const Fault kFaults[] = { Fault::NackWrite, Fault::ShortRead };
+    auto const nTransfers = runOnce(fScheduled, Fault::None, 0);
+    auto const nFailures = hostTestFailures();
+
+    for (auto const fault : kFaults)
+        {
+        for (std::uint32_t nSkip = 0; nSkip < nTransfers; ++nSkip)
+            runOnce(fScheduled, fault, nSkip);
+        }
+
+    std::printf("%s: %u transfers, %u fault runs, %s\n",
+        fScheduled ? "scheduled" : "direct",
+        unsigned(nTransfers), unsigned(2 * nTransfers),
+        hostTestFailures() == nFailures ? "ok" : "mismatch"
+        );
+    }
+
+int main()
+    {
+    testPath(false);
+    testPath(true);
+
+    return hostTestResult("test_accounting");
+    }
+
+/**** end of test_accounting.cpp ****/
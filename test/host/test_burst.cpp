@@ -0,0 +1,139 @@
+/*
+
+Module: test_burst.cpp
+
+Function:
+    Check that burst samples carry the configuration they were
+    taken with, across queued configuration changes.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "host_test.h"
+#include "sim_ltr329als.h"
+#include <mcci_ltr_329als.h>
+#include <cmath>
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Manifest constants & typedefs.
+|
+\****************************************************************************/
+
+/// the simulated light level.
+static constexpr float kLux = 500.0f;
+
+/// the longest wait for a sample, in ms.
+static constexpr std::uint32_t kSampleLimitMs = 2000;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+// poll for a sample; give up on error or after kSampleLimitMs.
+static bool waitReady(Ltr_329als &ltr)
+    {
+    auto const tStart = millis();
+    bool fError;
+
+    while (millis() - tStart < kSampleLimitMs)
+        {
+        if (ltr.queryReady(fError))
+            return true;
+        if (fError)
+            return false;
+        }
+
+    return false;
+    }
+
+//
+// run a burst of nSamples starting at (g0, iTime0), queueing (g1, iTime1)
+// after nBefore samples. Every sample must convert to the simulated
+// light level, which it can only do if it's labelled with the gain and
+// integration time it was taken with.
+//
+static void runBurst(
+    AlsGain_t::Gain_t g0, AlsMeasRate_t::Integration_t iTime0,
+    AlsGain_t::Gain_t g1, AlsMeasRate_t::Integration_t iTime1,
+    unsigned nBefore, unsigned nSamples
+    )
+    {
+    SimLtr329als_t sim;
+    Ltr_329als ltr {Wire};
+
+    Wire.reset();
+    Wire.attach(sim);
+    sim.setLux(kLux);
+
+    std::printf("burst %ux/%ums -> %ux/%ums:",
+        unsigned(g0), unsigned(iTime0), unsigned(g1), unsigned(iTime1));
+
+    if (! (HOST_CHECK(ltr.begin()) &&
+           HOST_CHECK(ltr.configure(g0, 1000, iTime0)) &&
+           HOST_CHECK(ltr.startBurst(std::uint16_t(nSamples)))))
+        return;
+
+    bool fChanged = false;
+
+    for (unsigned i = 0; i < nSamples; ++i)
+        {
+        if (i == nBefore)
+            HOST_CHECK(ltr.queueBurstConfig(g1, iTime1));
+
+        if (! HOST_CHECK(waitReady(ltr)))
+            break;
+
+        auto const &sample = ltr.getRawData();
+        auto const lux = ltr.getLux();
+
+        std::printf(" %ux/%ums=%.0f",
+            unsigned(sample.getGain()), unsigned(sample.getIntegrationTime()), double(lux));
+
+        HOST_CHECK(std::fabs(lux - kLux) < kLux * 0.02f);
+
+        // the labels change once, and only after the change is queued.
+        bool const fNew = sample.getGain() == g1 && sample.getIntegrationTime() == iTime1;
+        if (i < nBefore)
+            HOST_CHECK(sample.getGain() == g0 && sample.getIntegrationTime() == iTime0);
+        else if (fChanged)
+            HOST_CHECK(fNew);
+        fChanged = fChanged || fNew;
+        }
+
+    std::printf("\n");
+    HOST_CHECK(fChanged);
+    HOST_CHECK(ltr.getBurstRemaining() == 0);
+    HOST_CHECK(ltr.getState() == Ltr_329als::State::Idle);
+    }
+
+int main()
+    {
+    // integration time only: the sensor's status doesn't show the change.
+    // When the old rate equals the old integration time, the sample under
+    // way at the change is the next one read.
+    runBurst(1, 200, 1, 100, 2, 6);
+    runBurst(1, 100, 1, 50, 2, 6);
+    runBurst(1, 100, 1, 400, 2, 6);
+    runBurst(1, 400, 1, 100, 2, 6);
+
+    // rate longer than the integration time.
+    runBurst(1, 150, 1, 50, 2, 6);
+
+    // gain only, and both.
+    runBurst(1, 100, 8, 100, 2, 6);
+    runBurst(2, 200, 4, 50, 3, 8);
+
+    return hostTestResult("test_burst");
+    }
+
+/**** end of test_burst.cpp ****/
@@ -0,0 +1,156 @@
+/*
+
+Module: test_group.cpp
+
+Function:
+    Check that a group of sensors stops and completes a round of
+    samples when its members differ or fail.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "host_test.h"
+#include "sim_ltr329als.h"
+#include "sim_tca9548a.h"
+#include <mcci_ltr_329als.h>
+#include <mcci_ltr_329als_group.h>
+#include <mcci_ltr_329als_mux.h>
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Manifest constants & typedefs.
+|
+\****************************************************************************/
+
+/// the number of sensors in the group.
+static constexpr unsigned kSensors = 2;
+
+/// the longest wait for a round of samples, in ms.
+static constexpr std::uint32_t kSampleLimitMs = 2000;
+
+/// ALS_CONTR.
+static constexpr std::uint8_t kRegContr = 0x80;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+// poll for a round; give up after kSampleLimitMs.
+static bool waitAllReady(Ltr_329alsGroup &group, bool &fError)
+    {
+    auto const tStart = millis();
+
+    while (millis() - tStart < kSampleLimitMs)
+        {
+        if (group.queryAllReady(fError))
+            return true;
+        }
+
+    return false;
+    }
+
+// the gain field of an ALS_CONTR value.
+static std::uint8_t contrGain(std::uint8_t contr)
+    {
+    return (contr >> 2) & 0x7;
+    }
+
+// a member that failed must not hold up the others' round.
+static void testMemberFails()
+    {
+    SimTca9548a_t simMux;
+    SimLtr329als_t sim[kSensors];
+    Ltr_329als ltr0 {Wire}, ltr1 {Wire};
+    Tca9548a_t mux {Wire};
+    Ltr_329alsGroup group {mux};
+    bool fError;
+
+    std::printf("member fails\n");
+    Wire.reset();
+    Wire.attach(simMux);
+    simMux.connect(0, sim[0]);
+    simMux.connect(1, sim[1]);
+    group.add(ltr0, 0);
+    group.add(ltr1, 1);
+
+    if (! (HOST_CHECK(group.begin()) && HOST_CHECK(group.startMeasurement(false))))
+        return;
+
+    HOST_CHECK(waitAllReady(group, fError));
+    HOST_CHECK(! fError);
+    HOST_CHECK(group.getErrorMask() == 0);
+
+    // the round ends with the error, and the survivor's sample.
+    sim[1].powerDown();
+    HOST_CHECK(waitAllReady(group, fError));
+    HOST_CHECK(fError);
+    HOST_CHECK(group.getErrorMask() == 0x2);
+    HOST_CHECK(ltr0.getLux() > 0.0f);
+    }
+
+// members whose gains differ are each stopped with their own gain.
+static void testStopMixedGains()
+    {
+    SimTca9548a_t simMux;
+    SimLtr329als_t sim[kSensors];
+    Ltr_329als ltr0 {Wire}, ltr1 {Wire};
+    Tca9548a_t mux {Wire};
+    Ltr_329alsGroup group {mux};
+
+    std::printf("stop with mixed gains\n");
+    Wire.reset();
+    Wire.attach(simMux);
+    simMux.connect(0, sim[0]);
+    simMux.connect(1, sim[1]);
+    group.add(ltr0, 0);
+    group.add(ltr1, 1);
+
+    if (! HOST_CHECK(group.begin()))
+        return;
+
+    // one member plain at gain 1; the other in HDR, with user gain 8.
+    HOST_CHECK(group.select(0));
+    HOST_CHECK(ltr0.configure(1, 100, 100));
+    HOST_CHECK(ltr0.startMeasurement(false));
+    HOST_CHECK(group.select(1));
+    HOST_CHECK(ltr1.configure(8, 100, 100));
+    HOST_CHECK(ltr1.startHdrMeasurement(1, 96));
+
+    HOST_CHECK(group.stopMeasurement());
+    HOST_CHECK(ltr0.getState() == Ltr_329als::State::Idle);
+    HOST_CHECK(ltr1.getState() == Ltr_329als::State::Idle);
+
+    // both in standby, each with its own gain.
+    auto const contr0 = sim[0].getRegister(kRegContr);
+    auto const contr1 = sim[1].getRegister(kRegContr);
+    HOST_CHECK((contr0 & 0x1) == 0);
+    HOST_CHECK((contr1 & 0x1) == 0);
+    HOST_CHECK(contrGain(contr0) == 0);
+    HOST_CHECK(contrGain(contr1) == 3);
+
+    // and a common restart goes on as before.
+    bool fError;
+    HOST_CHECK(group.startMeasurement(false));
+    HOST_CHECK(waitAllReady(group, fError));
+    HOST_CHECK(! fError);
+    HOST_CHECK(group.stopMeasurement());
+    }
+
+int main()
+    {
+    testMemberFails();
+    testStopMixedGains();
+
+    return hostTestResult("test_group");
+    }
+
+/**** end of test_group.cpp ****/
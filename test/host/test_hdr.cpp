@@ -0,0 +1,130 @@
+/*
+
+Module: test_hdr.cpp
+
+Function:
+    Check the cadence and selection of HDR measurements.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "host_test.h"
+#include "sim_ltr329als.h"
+#include <mcci_ltr_329als.h>
+#include <cmath>
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Manifest constants & typedefs.
+|
+\****************************************************************************/
+
+using HdrSelect = Ltr_329als::HdrSelect;
+
+/// the number of fused results to check in each run.
+static constexpr unsigned kResults = 6;
+
+/// the slack allowed on each interval, for the 10 ms status poll.
+static constexpr std::uint32_t kSlackMs = 15;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+// poll for a sample; give up on error or after limitMs.
+static bool waitReady(Ltr_329als &ltr, std::uint32_t limitMs)
+    {
+    auto const tStart = millis();
+    bool fError;
+
+    while (millis() - tStart < limitMs)
+        {
+        if (ltr.queryReady(fError))
+            return true;
+        if (fError)
+            return false;
+        }
+
+    return false;
+    }
+
+//
+// run HDR with the given rate and integration time. Every result must
+// arrive within two measurement periods of the last, convert to the
+// simulated light level, and come from the expected gain.
+//
+static void runHdr(
+    AlsMeasRate_t::Rate_t rate,
+    AlsMeasRate_t::Integration_t iTime,
+    float lux,
+    HdrSelect expected
+    )
+    {
+    SimLtr329als_t sim;
+    Ltr_329als ltr {Wire};
+    std::uint32_t const period = rate > iTime ? rate : iTime;
+    std::uint32_t const limit = 2 * period + kSlackMs;
+
+    Wire.reset();
+    Wire.attach(sim);
+    sim.setLux(lux);
+
+    std::printf("hdr %ums/%ums at %.0f lux:", unsigned(rate), unsigned(iTime), double(lux));
+
+    if (! (HOST_CHECK(ltr.begin()) &&
+           HOST_CHECK(ltr.configure(1, rate, iTime)) &&
+           HOST_CHECK(ltr.startHdrMeasurement(1, 96))))
+        return;
+
+    // the first result: the wakeup delay, then one sample at each gain,
+    // plus the low-gain sample under way when the gain is first switched.
+    auto tLast = millis();
+    if (! HOST_CHECK(waitReady(ltr, 3 * period + kSlackMs + SimLtr329als_t::kWakeupMs)))
+        return;
+
+    for (unsigned i = 0; i < kResults; ++i)
+        {
+        if (i != 0 && ! HOST_CHECK(waitReady(ltr, limit)))
+            break;
+
+        auto const now = millis();
+        auto const result = ltr.getLux();
+
+        std::printf(" %ums/%ux=%.0f", unsigned(now - tLast), unsigned(ltr.getRawData().getGain()), double(result));
+        HOST_CHECK(std::fabs(result - lux) < lux * 0.02f);
+        HOST_CHECK(ltr.getHdrSelection() == expected);
+        tLast = now;
+        }
+
+    std::printf("\n");
+    HOST_CHECK(ltr.stopMeasurement());
+    HOST_CHECK(ltr.getState() == Ltr_329als::State::Idle);
+    }
+
+int main()
+    {
+    // rate equal to the integration time: the next sample is under way
+    // when each one is harvested.
+    runHdr(100, 100, 50.0f, HdrSelect::High);
+    runHdr(200, 200, 50.0f, HdrSelect::High);
+
+    // rate longer than the integration time: the gain switch is in time
+    // for the next sample.
+    runHdr(200, 150, 50.0f, HdrSelect::High);
+
+    // too bright for the high gain.
+    runHdr(100, 100, 5000.0f, HdrSelect::Low);
+
+    return hostTestResult("test_hdr");
+    }
+
+/**** end of test_hdr.cpp ****/
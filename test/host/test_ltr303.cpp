@@ -0,0 +1,225 @@
+/*
+
+Module: test_ltr303.cpp
+
+Function:
+    Check the LTR-303ALS driver's use of the INT pin.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "host_test.h"
+#include "sim_ltr303als.h"
+#include <mcci_ltr_303als.h>
+#include <cmath>
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Manifest constants & typedefs.
+|
+\****************************************************************************/
+
+using IntPolarity = Ltr_303als::IntPolarity;
+
+/// the pin wired to INT.
+static constexpr std::uint8_t kPinInt = 7;
+
+/// the simulated light level inside the threshold window.
+static constexpr float kLuxInside = 500.0f;
+
+/// the simulated light level above the threshold window.
+static constexpr float kLuxAbove = 1500.0f;
+
+/****************************************************************************\
+|
+|   Variables.
+|
+\****************************************************************************/
+
+static Ltr_303als *gpLtr;
+static unsigned gnIsr;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+static void isr()
+    {
+    ++gnIsr;
+    if (gpLtr != nullptr)
+        gpLtr->notifyInterrupt();
+    }
+
+static bool isNear(float lux, float expected)
+    {
+    return std::fabs(lux - expected) < expected * 0.02f;
+    }
+
+// poll for up to limitMs; the sensor runs whether or not it's polled.
+static bool waitReady(SimLtr303als_t &sim, Ltr_303als &ltr, std::uint32_t limitMs, bool &fError)
+    {
+    auto const tStart = millis();
+
+    fError = false;
+    while (millis() - tStart < limitMs)
+        {
+        sim.update();
+        if (ltr.queryReady(fError))
+            return true;
+        if (fError)
+            return false;
+        }
+
+    return false;
+    }
+
+// set up a sensor and driver, with the interrupt attached.
+static bool startLtr(SimLtr303als_t &sim, Ltr_303als &ltr, IntPolarity polarity)
+    {
+    Wire.reset();
+    Wire.attach(sim);
+    sim.setLux(kLuxInside);
+
+    gpLtr = &ltr;
+    gnIsr = 0;
+    pinMode(kPinInt, INPUT_PULLUP);
+    attachInterrupt(
+        digitalPinToInterrupt(kPinInt),
+        isr,
+        polarity == IntPolarity::ActiveLow ? FALLING : RISING
+        );
+
+    if (! (HOST_CHECK(ltr.begin()) && HOST_CHECK(ltr.configure(1, 100, 100))))
+        return false;
+
+    // interrupt mode, with the requested polarity; INT is released.
+    auto const interrupt = sim.getRegister(0x8F);
+    HOST_CHECK(interrupt & 0x02);
+    HOST_CHECK(bool(interrupt & 0x04) == (polarity == IntPolarity::ActiveHigh));
+    HOST_CHECK(digitalRead(kPinInt) == (polarity == IntPolarity::ActiveLow ? HIGH : LOW));
+    return true;
+    }
+
+static void stopLtr(Ltr_303als &ltr)
+    {
+    ltr.end();
+    detachInterrupt(digitalPinToInterrupt(kPinInt));
+    gpLtr = nullptr;
+    }
+
+// without thresholds, every sample asserts INT, and the driver only
+// reads ALS_STATUS after INT.
+static void testEverySample(IntPolarity polarity)
+    {
+    SimLtr303als_t sim {kPinInt};
+    Ltr_303als ltr {Wire, polarity};
+    constexpr unsigned kSamples = 5;
+    bool fError;
+
+    std::printf("every sample, %s\n", polarity == IntPolarity::ActiveLow ? "active low" : "active high");
+    if (! startLtr(sim, ltr, polarity))
+        return;
+
+    HOST_CHECK(ltr.startMeasurement(false));
+    auto const nStatusReads = sim.getStatusReads();
+
+    for (unsigned i = 0; i < kSamples; ++i)
+        {
+        if (! HOST_CHECK(waitReady(sim, ltr, 500, fError)))
+            break;
+
+        HOST_CHECK(isNear(ltr.getLux(), kLuxInside));
+        }
+
+    HOST_CHECK(sim.getStatusReads() - nStatusReads == kSamples);
+    HOST_CHECK(gnIsr == sim.getIntCount());
+    HOST_CHECK(gnIsr >= kSamples);
+
+    // a single measurement also completes on INT.
+    HOST_CHECK(ltr.stopMeasurement());
+    HOST_CHECK(ltr.startMeasurement(true));
+    HOST_CHECK(waitReady(sim, ltr, 500, fError));
+    HOST_CHECK(isNear(ltr.getLux(), kLuxInside));
+
+    stopLtr(ltr);
+    }
+
+// with thresholds, INT is only asserted outside the window, after the
+// persistence count; until then, continuous measurement waits without
+// timing out or touching the bus.
+static void testThresholds(IntPolarity polarity)
+    {
+    SimLtr303als_t sim {kPinInt};
+    Ltr_303als ltr {Wire, polarity};
+    bool fError;
+
+    std::printf("thresholds, %s\n", polarity == IntPolarity::ActiveLow ? "active low" : "active high");
+    if (! startLtr(sim, ltr, polarity))
+        return;
+
+    // 500 lux is about 244 counts at gain 1, 100 ms.
+    HOST_CHECK(ltr.setInterruptThresholds(100, 400, 2));
+    HOST_CHECK(sim.getRegister(0x9E) == 1);
+    HOST_CHECK(ltr.startMeasurement(false));
+
+    // far longer than the timeout for one sample.
+    auto const nTransfers = Wire.getTransfers();
+    auto const nConversions = sim.getConversions();
+    HOST_CHECK(! waitReady(sim, ltr, 5000, fError));
+    HOST_CHECK(! fError);
+    HOST_CHECK(ltr.getLastError() == Ltr_329als::Error::Busy);
+    HOST_CHECK(ltr.getState() == Ltr_329als::State::Continuous);
+    HOST_CHECK(sim.getConversions() - nConversions >= 40);
+    HOST_CHECK(Wire.getTransfers() == nTransfers);
+    HOST_CHECK(gnIsr == 0);
+
+    // leave the window: INT after two samples outside it.
+    sim.setLux(kLuxAbove);
+    auto const nBefore = sim.getConversions();
+    HOST_CHECK(waitReady(sim, ltr, 500, fError));
+    HOST_CHECK(sim.getConversions() - nBefore >= 2);
+    HOST_CHECK(isNear(ltr.getLux(), kLuxAbove));
+    HOST_CHECK(gnIsr == 1);
+
+    // back inside: quiet again.
+    sim.setLux(kLuxInside);
+    HOST_CHECK(! waitReady(sim, ltr, 2000, fError));
+    HOST_CHECK(! fError);
+    HOST_CHECK(gnIsr == 1);
+
+    // a single measurement inside the window polls ALS_STATUS.
+    HOST_CHECK(ltr.stopMeasurement());
+    HOST_CHECK(ltr.startMeasurement(true));
+    HOST_CHECK(waitReady(sim, ltr, 500, fError));
+    HOST_CHECK(isNear(ltr.getLux(), kLuxInside));
+    HOST_CHECK(gnIsr == 1);
+
+    // clearing the thresholds brings back INT for every sample.
+    HOST_CHECK(ltr.clearInterruptThresholds());
+    HOST_CHECK(ltr.startMeasurement(false));
+    HOST_CHECK(waitReady(sim, ltr, 500, fError));
+    HOST_CHECK(gnIsr == 2);
+
+    stopLtr(ltr);
+    }
+
+int main()
+    {
+    testEverySample(IntPolarity::ActiveLow);
+    testEverySample(IntPolarity::ActiveHigh);
+    testThresholds(IntPolarity::ActiveLow);
+    testThresholds(IntPolarity::ActiveHigh);
+
+    return hostTestResult("test_ltr303");
+    }
+
+/**** end of test_ltr303.cpp ****/
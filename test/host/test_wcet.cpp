@@ -0,0 +1,414 @@
+/*
+
+Module: test_wcet.cpp
+
+Function:
+    Check the execution time of every recorded driver method, with
+    bus and sensor faults injected.
+
+Copyright and License:
+    See accompanying LICENSE file for copyright and license information.
+
+Author:
+    Terry Moore, MCCI Corporation   July 2022
+
+*/
+
+#include "host_test.h"
+#include "sim_ltr303als.h"
+#include "sim_tca9548a.h"
+#include <mcci_ltr_303als.h>
+#include <mcci_ltr_329als_group.h>
+
+using namespace Mcci_Ltr_329als;
+
+/****************************************************************************\
+|
+|   Manifest constants & typedefs.
+|
+\****************************************************************************/
+
+using Method = WcetRecorder_t::Method;
+using Fault = TwoWire::Fault;
+
+/// budget for every method that doesn't wait for the sensor, in us at 100 kHz.
+static constexpr std::uint32_t kBudgetUs = 3000;
+
+/// budget for begin() and resume(), which may wait for the sensor to start.
+static constexpr std::uint32_t kStartupBudgetUs =
+    (LTR_329ALS_PARAMS::getMaxInitialDelayMs() + LTR_329ALS_PARAMS::getWakeupDelayMs() + 20) * 1000;
+
+/// the shortest time begin() may take to give up on an absent sensor, in us.
+/// The driver measures its deadline in whole ms from its own start.
+static constexpr std::uint32_t kGiveUpUs =
+    (LTR_329ALS_PARAMS::getMaxInitialDelayMs() - 1) * 1000;
+
+/// the pin wired to the LTR-303ALS \c INT output.
+static constexpr std::uint8_t kPinInt = 7;
+
+/// the longest wait for a sample, in ms.
+static constexpr std::uint32_t kSampleLimitMs = 2000;
+
+/// an output that discards everything.
+class NullPrint_t : public Print
+    {
+public:
+    virtual size_t write(std::uint8_t c) override
+        {
+        (void) c;
+        return 1;
+        }
+    };
+
+/****************************************************************************\
+|
+|   Variables.
+|
+\****************************************************************************/
+
+static std::uint32_t readClock()
+    {
+    return hostGetMicros();
+    }
+
+static WcetRecorder_t gWcet {readClock};
+static NullPrint_t gNull;
+
+/****************************************************************************\
+|
+|   Code.
+|
+\****************************************************************************/
+
+// poll for a sample; give up on error or after kSampleLimitMs.
+static bool waitReady(Ltr_329als &ltr)
+    {
+    auto const tStart = millis();
+    bool fError;
+
+    while (millis() - tStart < kSampleLimitMs)
+        {
+        if (ltr.queryReady(fError))
+            return true;
+        if (fError)
+            return false;
+        }
+
+    return false;
+    }
+
+// start the driver without blocking.
+static bool startLtr(Ltr_329als &ltr)
+    {
+    auto const tStart = millis();
+    bool fError;
+
+    if (! ltr.startBegin())
+        return false;
+
+    while (! ltr.queryBeginDone(fError))
+        {
+        if (fError)
+            return false;
+
+        // the driver has its own deadline; this is a backstop.
+        if (! HOST_CHECK(millis() - tStart < 2 * LTR_329ALS_PARAMS::getMaxInitialDelayMs()))
+            return false;
+
+        yield();
+        }
+
+    return true;
+    }
+
+// call every recorded Ltr_329als method at least once. When faults are
+// injected, calls fail; they must still return within budget.
+static void runScenario(Ltr_329als &ltr)
+    {
+    Ltr_329als::RetainedState_t state;
+    bool fError;
+    float lux;
+
+    startLtr(ltr);
+    ltr.readProductInfo();
+    ltr.configure(1, 100, 50);
+
+    ltr.startMeasurement(true);
+    waitReady(ltr);
+    ltr.getLux();
+    ltr.getPollIntervalMs();
+
+    // getLux(maxAge) runs its own single measurement.
+    auto const tStart = millis();
+    while (! ltr.getLux(0, lux, fError) && ! fError && millis() - tStart < kSampleLimitMs)
+        ;
+
+    ltr.setDeadband(10, 50, 1000);
+    ltr.startMeasurement(false);
+    for (unsigned i = 0; i < 3; ++i)
+        waitReady(ltr);
+    ltr.stopMeasurement();
+    ltr.clearDeadband();
+
+    ltr.startHdrMeasurement(1, 96);
+    for (unsigned i = 0; i < 4; ++i)
+        waitReady(ltr);
+    ltr.stopMeasurement();
+
+    ltr.startBurst(4);
+    ltr.queueBurstConfig(2, 100);
+    for (unsigned i = 0; i < 4; ++i)
+        waitReady(ltr);
+    ltr.getBurstRateMilliHz();
+
+    ltr.setThresholds(100, 1000, 2);
+    ltr.startMeasurement(false);
+    for (unsigned i = 0; i < 2; ++i)
+        waitReady(ltr);
+    ltr.stopMeasurement();
+    ltr.clearThresholds();
+
+    ltr.saveState(state);
+    ltr.end();
+    ltr.resume(state);
+    ltr.dumpStateTrace(gNull);
+
+    ltr.reset();
+    ltr.begin();
+    ltr.end();
+    }
+
+// the methods only the LTR-303ALS has.
+static void run303Scenario(Ltr_303als &ltr)
+    {
+    ltr.setInterruptThresholds(100, 1000, 2);
+    startLtr(ltr);
+    ltr.setInterruptThresholds(100, 1000, 2);
+    ltr.clearInterruptThresholds();
+    ltr.end();
+    }
+
+// report, and clear, any budget overrun in the last run.
+static void checkBudgets(const char *pRun, Fault fault, std::uint32_t nSkip, std::uint32_t nCount)
+    {
+    auto const mask = gWcet.getOverrunMask();
+
+    if (! HOST_CHECK(mask == 0))
+        {
+        std::printf("  %s: fault %u skip %u count %u:", pRun, unsigned(fault), unsigned(nSkip), unsigned(nCount));
+        for (unsigned i = 0; i < WcetRecorder_t::kMethods; ++i)
+            {
+            if (mask & (std::uint32_t(1) << i))
+                std::printf(" %s", WcetRecorder_t::getMethodName(Method(i)));
+            }
+        std::printf("\n");
+        }
+
+    gWcet.reset();
+    }
+
+// run both scenarios with one fault; return the number of transfers.
+static std::uint32_t runOnce(Fault fault, std::uint32_t nSkip, std::uint32_t nCount, bool fStuckStatus)
+    {
+    SimLtr329als_t sim;
+    SimLtr303als_t sim303 {kPinInt};
+    Ltr_329als ltr {Wire};
+    Ltr_303als ltr303 {Wire};
+
+    Wire.reset();
+    Wire.attach(sim);
+    sim.powerUp();
+    sim.setStuckStatus(fStuckStatus);
+    ltr.setWcetRecorder(&gWcet);
+    Wire.injectFault(fault, nSkip, nCount);
+    runScenario(ltr);
+    auto const nTransfers = Wire.getTransfers();
+
+    Wire.reset();
+    Wire.attach(sim303);
+    sim303.powerUp();
+    ltr303.setWcetRecorder(&gWcet);
+    Wire.injectFault(fault, nSkip, nCount);
+    run303Scenario(ltr303);
+
+    return nTransfers;
+    }
+
+// every method is recorded, and none overruns without faults.
+static std::uint32_t testClean()
+    {
+    auto const nTransfers = runOnce(Fault::None, 0, 0, false);
+
+    std::printf("clean run: %u transfers\n", unsigned(nTransfers));
+    for (unsigned i = 0; i < WcetRecorder_t::kMethods; ++i)
+        {
+        auto const m = Method(i);
+
+        std::printf("  %-26s n=%-5u worst=%u us\n",
+            WcetRecorder_t::getMethodName(m),
+            unsigned(gWcet.getCount(m)),
+            unsigned(gWcet.getWorstCase(m))
+            );
+        HOST_CHECK(gWcet.getCount(m) != 0);
+        }
+
+    checkBudgets("clean", Fault::None, 0, 0);
+    return nTransfers;
+    }
+
+// inject each fault at each point in the scenario.
+static void testFaults(std::uint32_t nTransfers)
+    {
+    static const Fault kFaults[] = { Fault::NackWrite, Fault::ShortRead };
+    unsigned nRuns = 0;
+
+    for (auto const fault : kFaults)
+        {
+        for (std::uint32_t nSkip = 0; nSkip <= nTransfers; ++nSkip)
+            {
+            runOnce(fault, nSkip, 1, false);
+            checkBudgets("transient", fault, nSkip, 1);
+
+            runOnce(fault, nSkip, TwoWire::kForever, false);
+            checkBudgets("permanent", fault, nSkip, TwoWire::kForever);
+            nRuns += 2;
+            }
+        }
+
+    runOnce(Fault::None, 0, 0, true);
+    checkBudgets("stuck status", Fault::None, 0, 0);
+    ++nRuns;
+
+    std::printf("fault runs: %u\n", nRuns);
+    }
+
+// resume() falls back to begin(), which waits for the sensor.
+static void testResumeFallback()
+    {
+    SimLtr329als_t sim;
+    Ltr_329als ltr {Wire};
+    Ltr_329als::RetainedState_t state;
+
+    Wire.reset();
+    Wire.attach(sim);
+    sim.powerUp();
+    ltr.setWcetRecorder(&gWcet);
+
+    HOST_CHECK(ltr.begin());
+    HOST_CHECK(ltr.saveState(state));
+
+    // the sensor kept power: one read, no waiting.
+    ltr.end();
+    auto tStart = hostGetMicros();
+    HOST_CHECK(ltr.resume(state));
+    HOST_CHECK(hostGetMicros() - tStart < kBudgetUs);
+
+    // the sensor lost power: ALS_MEAS_RATE is back to its reset value.
+    ltr.end();
+    sim.powerUp();
+    tStart = hostGetMicros();
+    HOST_CHECK(ltr.resume(state));
+    HOST_CHECK(hostGetMicros() - tStart >= SimLtr329als_t::kPowerUpMs * 1000);
+
+    // the read fails once.
+    ltr.end();
+    Wire.injectFault(Fault::NackWrite, 0, 1);
+    HOST_CHECK(ltr.resume(state));
+
+    // the retained state is corrupt.
+    ltr.end();
+    state.check ^= 1;
+    HOST_CHECK(ltr.resume(state));
+    state.check ^= 1;
+
+    // the sensor is gone: begin() waits for it as long as it may.
+    ltr.end();
+    sim.powerDown();
+    tStart = hostGetMicros();
+    HOST_CHECK(! ltr.resume(state));
+    auto const elapsed = hostGetMicros() - tStart;
+    HOST_CHECK(elapsed >= kGiveUpUs);
+    HOST_CHECK(elapsed <= kStartupBudgetUs);
+    std::printf("resume with no sensor: %u us\n", unsigned(elapsed));
+
+    HOST_CHECK(gWcet.getCount(Method::Resume) == 5);
+    checkBudgets("resume", Fault::None, 0, 0);
+    }
+
+// start a group; return the time taken.
+static std::uint32_t runGroupBegin(unsigned nSensors, std::uint32_t absentMask, Fault fault, std::uint32_t nSkip, std::uint32_t nCount)
+    {
+    SimTca9548a_t simMux;
+    SimLtr329als_t sim[4];
+    Ltr_329als ltr0 {Wire}, ltr1 {Wire}, ltr2 {Wire}, ltr3 {Wire};
+    Ltr_329als * const pLtr[4] = { &ltr0, &ltr1, &ltr2, &ltr3 };
+    Tca9548a_t mux {Wire};
+    Ltr_329alsGroup group {mux};
+
+    Wire.reset();
+    Wire.attach(simMux);
+    for (unsigned i = 0; i < nSensors; ++i)
+        {
+        simMux.connect(i, sim[i]);
+        sim[i].powerUp();
+        if (absentMask & (1u << i))
+            sim[i].powerDown();
+
+        pLtr[i]->setWcetRecorder(&gWcet);
+        group.add(*pLtr[i], std::uint8_t(i));
+        }
+
+    Wire.injectFault(fault, nSkip, nCount);
+
+    auto const tStart = hostGetMicros();
+    bool const fResult = group.begin();
+    auto const elapsed = hostGetMicros() - tStart;
+
+    if (fault == Fault::None)
+        {
+        HOST_CHECK(fResult == (absentMask == 0));
+        HOST_CHECK(group.getFailedMask() == absentMask);
+        }
+
+    HOST_CHECK(elapsed <= kStartupBudgetUs);
+    return elapsed;
+    }
+
+// a group starts in about the time of one sensor, and no longer than one can take.
+static void testGroupBegin()
+    {
+    auto const tOne = runGroupBegin(1, 0, Fault::None, 0, 0);
+    auto const tFour = runGroupBegin(4, 0, Fault::None, 0, 0);
+    auto const tAbsent = runGroupBegin(4, 0x4, Fault::None, 0, 0);
+
+    std::printf("group begin: 1 sensor %u us, 4 sensors %u us, 1 of 4 absent %u us\n",
+        unsigned(tOne), unsigned(tFour), unsigned(tAbsent));
+
+    // the start-up delays overlap.
+    HOST_CHECK(tFour < tOne + 20000);
+    HOST_CHECK(tAbsent >= kGiveUpUs);
+
+    for (std::uint32_t nSkip = 0; nSkip < 40; ++nSkip)
+        {
+        runGroupBegin(4, 0, Fault::NackWrite, nSkip, 1);
+        runGroupBegin(4, 0, Fault::ShortRead, nSkip, 1);
+        }
+
+    checkBudgets("group", Fault::None, 0, 0);
+    }
+
+int main()
+    {
+    gWcet.setBudget(kBudgetUs);
+    gWcet.setBudget(Method::Begin, kStartupBudgetUs);
+    gWcet.setBudget(Method::Resume, kStartupBudgetUs);
+
+    auto const nTransfers = testClean();
+    testFaults(nTransfers);
+    testResumeFallback();
+    testGroupBegin();
+
+    return hostTestResult("test_wcet");
+    }
+
+/**** end of test_wcet.cpp ****/